@@ -0,0 +1,295 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/** @file
+ *  Defines the AT Command Host Client Interface.
+ *
+ *  This file provides the functions and definitions for sending AT commands to a device
+ *  running the AT Command Parser library and matching the responses to the commands.
+ *  The client is only built when ENABLE_AT_CMD_HOST is defined.
+ */
+
+/**
+ * \defgroup group_at_cmd_host AT Command Host Client API
+ * \brief The AT Command Host Client API provides functions for a host to send pipelined commands to the AT Command Parser library.
+ * \addtogroup group_at_cmd_host
+ * \{
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cy_result.h"
+#include "at_command_parser.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#ifndef AT_CMD_HOST_MAX_PENDING
+/** Number of commands that can wait for a response at one time. */
+#define AT_CMD_HOST_MAX_PENDING                     (32)
+#endif
+
+#ifndef AT_CMD_HOST_BUFFER_SIZE
+/** Size of the buffers for one command frame and one received message. */
+#define AT_CMD_HOST_BUFFER_SIZE                     (6 * 1024 + 32)
+#endif
+
+/******************************************************
+ *                      Enums
+ ******************************************************/
+
+/**
+ * Receive state. Internal to the client.
+ */
+
+typedef enum
+{
+    AT_CMD_HOST_RX_SCAN = 0,            /**< Looking for the '+' that starts a message */
+    AT_CMD_HOST_RX_TYPE,                /**< Reading the message type                  */
+    AT_CMD_HOST_RX_SIZE,                /**< Reading the four digit size and ','       */
+    AT_CMD_HOST_RX_SERIAL,              /**< Reading the serial number                 */
+    AT_CMD_HOST_RX_BODY,                /**< Reading the message body                  */
+    AT_CMD_HOST_RX_TRAILER              /**< Reading the trailing ';'                  */
+} at_cmd_host_rx_state_t;
+
+/******************************************************
+ *                 Type Definitions
+ ******************************************************/
+
+/** Write data to the device.
+ *
+ * @param[in] data   : Pointer to the data.
+ * @param[in] len    : Length of the data in bytes.
+ * @param[in] opaque : Opaque pointer given to at_cmd_host_init().
+ *
+ * @return    Status of the operation.
+ */
+
+typedef cy_rslt_t (*at_cmd_host_write_t)(const uint8_t *data, uint32_t len, void *opaque);
+
+/** Called when the status response for a command is received.
+ *
+ * @param[in] serial   : Serial number of the command.
+ * @param[in] status   : Status of the command. AT_CMD_STATUS_SUCCESS or an error number.
+ * @param[in] text     : Nul terminated response text. Empty if the response has no text.
+ * @param[in] text_len : Length of the response text.
+ * @param[in] arg      : Argument given when the command was sent.
+ */
+
+typedef void (*at_cmd_host_response_cb_t)(uint32_t serial, uint32_t status, const char *text, uint32_t text_len, void *arg);
+
+/** Called when an asynchronous message is received.
+ *
+ * @param[in] serial   : Serial number of the command which caused the message, 0 if none.
+ * @param[in] name     : Nul terminated message name.
+ * @param[in] text     : Nul terminated JSON text of the message.
+ * @param[in] text_len : Length of the JSON text.
+ * @param[in] arg      : Argument given when the command was sent, or to at_cmd_host_init().
+ */
+
+typedef void (*at_cmd_host_async_cb_t)(uint32_t serial, const char *name, const char *text, uint32_t text_len, void *arg);
+
+/**
+ * A command waiting for a response. Internal to the client.
+ */
+
+typedef struct
+{
+    uint32_t                    serial;         /**< Serial number, 0 if the entry is free            */
+    bool                        responded;      /**< Status received, entry kept for async messages   */
+    at_cmd_host_response_cb_t   response_cb;    /**< Status response callback                         */
+    at_cmd_host_async_cb_t      async_cb;       /**< Asynchronous message callback                    */
+    void                        *arg;           /**< Callback argument                                */
+} at_cmd_host_pending_t;
+
+/**
+ * Host client instance.
+ *
+ * The fields are internal to the client and must not be accessed by the application.
+ * An instance must only be used from one thread at a time.
+ */
+
+typedef struct
+{
+    at_cmd_host_write_t         write;                                  /**< Transport write function          */
+    void                        *opaque;                                /**< Transport write argument          */
+    at_cmd_host_async_cb_t      async_cb;                               /**< Unclaimed asynchronous messages   */
+    at_cmd_host_response_cb_t   unmatched_cb;                           /**< Responses for unknown serials     */
+    void                        *arg;                                   /**< Argument for the callbacks above  */
+    uint32_t                    next_serial;                            /**< Next serial number to try         */
+    uint32_t                    timeout_ms;                             /**< Deadline sent with commands       */
+    uint32_t                    num_pending;                            /**< Entries in use                    */
+    at_cmd_host_pending_t       pending[AT_CMD_HOST_MAX_PENDING];       /**< Commands waiting for a response   */
+    char                        tx_buffer[AT_CMD_HOST_BUFFER_SIZE];     /**< Command frame being sent          */
+
+    at_cmd_host_rx_state_t      rx_state;                               /**< Receive state                     */
+    char                        rx_type;                                /**< Type of the message being read    */
+    uint32_t                    rx_digits;                              /**< Digits read in the current field  */
+    uint32_t                    rx_size;                                /**< Size of the message body          */
+    uint32_t                    rx_serial;                              /**< Serial number of the message      */
+    uint32_t                    rx_len;                                 /**< Body bytes read                   */
+    uint32_t                    rx_errors;                              /**< Malformed messages dropped        */
+    char                        rx_buffer[AT_CMD_HOST_BUFFER_SIZE + 1]; /**< Message body                      */
+#ifdef ENABLE_AT_CMD_COMPRESSION
+    char                        z_buffer[AT_CMD_HOST_BUFFER_SIZE + 1];  /**< Decompressed message body         */
+#endif
+} at_cmd_host_t;
+
+/******************************************************
+ *               Function Declarations
+ ******************************************************/
+
+/** Initialize a host client instance.
+ *
+ * @param[in] host         : Pointer to the client instance.
+ * @param[in] write        : Function used to write command frames to the device.
+ * @param[in] opaque       : Argument passed to the write function.
+ * @param[in] async_cb     : Called for asynchronous messages not claimed by a pending command. May be NULL.
+ * @param[in] unmatched_cb : Called for status responses that match no pending command, for example
+ *                           serial number 0 framing errors. May be NULL.
+ * @param[in] arg          : Argument passed to async_cb and unmatched_cb.
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_host_init(at_cmd_host_t *host, at_cmd_host_write_t write, void *opaque,
+                           at_cmd_host_async_cb_t async_cb, at_cmd_host_response_cb_t unmatched_cb, void *arg);
+
+
+/** Send a command without waiting for the response.
+ *
+ * Any number of commands up to AT_CMD_HOST_MAX_PENDING can be waiting for a response. Each command
+ * is given a serial number that is not in use by another pending command. The response_cb is called
+ * from at_cmd_host_input() when the status response is received.
+ *
+ * If async_cb is not NULL, asynchronous messages carrying the serial number of the command are passed
+ * to it instead of the instance callback, and the command stays pending after its status response until
+ * at_cmd_host_release() is called.
+ *
+ * @param[in]  host        : Pointer to the client instance.
+ * @param[in]  cmd_name    : Command name.
+ * @param[in]  args        : Command JSON text, or NULL for none.
+ * @param[in]  args_len    : Length of the command text.
+ * @param[in]  response_cb : Called with the status response. May be NULL.
+ * @param[in]  async_cb    : Called with asynchronous messages for the command. May be NULL.
+ * @param[in]  arg         : Argument passed to the callbacks.
+ * @param[out] serial      : Serial number of the command. May be NULL.
+ *
+ * @return    Status of the operation. CY_AT_CMD_PARSER_NO_MEMORY if too many commands are pending.
+ */
+
+cy_rslt_t at_cmd_host_send(at_cmd_host_t *host, const char *cmd_name, const char *args, uint32_t args_len,
+                           at_cmd_host_response_cb_t response_cb, at_cmd_host_async_cb_t async_cb, void *arg, uint32_t *serial);
+
+
+/** Send a binary command without waiting for the response.
+ *
+ * Same as at_cmd_host_send() but the data is sent in a binary command frame and may hold any byte values.
+ * The command must have a binary_parser callback on the device.
+ *
+ * @param[in]  host        : Pointer to the client instance.
+ * @param[in]  cmd_name    : Command name.
+ * @param[in]  data        : Command data, or NULL for none.
+ * @param[in]  data_len    : Length of the command data.
+ * @param[in]  response_cb : Called with the status response. May be NULL.
+ * @param[in]  async_cb    : Called with asynchronous messages for the command. May be NULL.
+ * @param[in]  arg         : Argument passed to the callbacks.
+ * @param[out] serial      : Serial number of the command. May be NULL.
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_host_send_binary(at_cmd_host_t *host, const char *cmd_name, const uint8_t *data, uint32_t data_len,
+                                  at_cmd_host_response_cb_t response_cb, at_cmd_host_async_cb_t async_cb, void *arg, uint32_t *serial);
+
+
+/** Set the deadline sent with the commands that follow.
+ *
+ * The device drops a command that is still waiting to run timeout_ms milliseconds after it was
+ * received and answers it with AT_CMD_STATUS_TIMEOUT.
+ *
+ * @param[in] host       : Pointer to the client instance.
+ * @param[in] timeout_ms : Deadline in milliseconds, 0 for none.
+ */
+
+void at_cmd_host_set_timeout(at_cmd_host_t *host, uint32_t timeout_ms);
+
+
+/** Pass data received from the device to the client.
+ *
+ * Complete messages are matched to the pending commands and the callbacks are called before
+ * the function returns. Command echo and anything else between messages is ignored. The callbacks
+ * may send new commands.
+ *
+ * @param[in] host : Pointer to the client instance.
+ * @param[in] data : Pointer to the received data.
+ * @param[in] len  : Length of the received data in bytes.
+ */
+
+void at_cmd_host_input(at_cmd_host_t *host, const uint8_t *data, uint32_t len);
+
+
+/** Stop waiting for a command.
+ *
+ * Frees the serial number of a command that has asynchronous messages routed to it, or of a command
+ * whose response will never arrive, for example after a host side timeout. No more callbacks are made
+ * for the command.
+ *
+ * @param[in] host   : Pointer to the client instance.
+ * @param[in] serial : Serial number of the command.
+ *
+ * @return    Status of the operation. CY_AT_CMD_PARSER_BAD_PARAM if the command is not pending.
+ */
+
+cy_rslt_t at_cmd_host_release(at_cmd_host_t *host, uint32_t serial);
+
+
+/** Get the number of commands waiting for a response.
+ *
+ * @param[in] host : Pointer to the client instance.
+ *
+ * @return    Number of pending commands.
+ */
+
+uint32_t at_cmd_host_pending(at_cmd_host_t *host);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** \} group_at_cmd_host */
@@ -57,6 +57,8 @@ extern "C" {
 #include "cy_result.h"
 #include "cyabs_rtos.h"
 
+#include "at_command_profile.h"
+
 /******************************************************
  *                    Constants
  ******************************************************/
@@ -106,12 +108,69 @@ extern "C" {
 #define CY_AT_CMD_PARSER_NO_MEMORY                  CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_AT_CMD_PARSER, 2)
 /** Command buffer overflow */
 #define CY_AT_CMD_PARSER_BUFFER_OVERFLOW            CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_AT_CMD_PARSER, 3)
+/** The requested feature is not enabled in this build */
+#define CY_AT_CMD_PARSER_UNSUPPORTED                CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_AT_CMD_PARSER, 4)
+/** \} group_at_cmd_parser_macros */
+
+/**
+ * \addtogroup group_at_cmd_parser_macros
+ * \{
+ */
+
+#ifndef AT_CMD_MAX_CMD_CLASSES
+/** Number of command routing classes. See at_cmd_def_t and at_cmd_params_t. */
+#define AT_CMD_MAX_CMD_CLASSES                      (4)
+#endif
+
+#ifndef AT_CMD_MAX_INLINE_MSG_SIZE
+/** Largest inline message size that can be set in at_cmd_params_t. See at_cmd_inline_callback_t. */
+#define AT_CMD_MAX_INLINE_MSG_SIZE                  (64)
+#endif
+
+/** Size of a message queue entry for the inline message size given in at_cmd_params_t. */
+#define AT_CMD_MSG_QUEUE_ENTRY_SIZE(inline_size)    (sizeof(at_cmd_msg_queue_t) + (inline_size))
+
+/** Command completed successfully */
+#define AT_CMD_STATUS_SUCCESS                       (0)
+/** Command failed */
+#define AT_CMD_STATUS_ERROR                         (1)
+/** Command was rejected because the application is busy. The host may retry the command later. */
+#define AT_CMD_STATUS_BUSY                          (2)
+/** Command was dropped because its deadline passed before it was run. */
+#define AT_CMD_STATUS_TIMEOUT                       (3)
+
+/** First command id used by the diagnostic command table. Application command ids must be lower. */
+#define AT_CMD_DIAG_CMD_ID_BASE                     (0xFFFFFF00)
+
 /** \} group_at_cmd_parser_macros */
 
 /******************************************************
  *                      Enums
  ******************************************************/
 
+/**
+ * \addtogroup group_at_cmd_parser_typedefs
+ * \{
+ */
+
+/**
+ * Output message classes.
+ *
+ * When several threads are waiting to send output, messages are sent in class order.
+ * Status responses go out first, followed by command echo and then asynchronous messages.
+ */
+
+typedef enum
+{
+    AT_CMD_OUTPUT_CLASS_STATUS = 0,     /**< Command status responses (+S)   */
+    AT_CMD_OUTPUT_CLASS_ECHO,           /**< Echo of received commands       */
+    AT_CMD_OUTPUT_CLASS_ASYNC,          /**< Asynchronous messages (+H, +Z)  */
+
+    AT_CMD_OUTPUT_CLASS_MAX             /**< Number of output classes        */
+} at_cmd_output_class_t;
+
+/** \} group_at_cmd_parser_typedefs */
+
 /******************************************************
  *                 Type Definitions
  ******************************************************/
@@ -131,17 +190,87 @@ typedef struct
 {
     uint32_t cmd_id;                /**< Command id for this message      */
     uint32_t serial;                /**< Serial number for this message   */
+    cy_time_t rx_time;              /**< Time the command was received. Set by the library. */
+    uint32_t timeout_ms;            /**< Deadline given by the host relative to rx_time, 0 if none.
+                                         Set by the library. */
 } at_cmd_msg_base_t;
 
 /**
  * Message queue structure for passing command messages.
+ *
+ * If inline_msg_size is set in the initialization parameters, each queue entry is followed
+ * by inline_msg_size bytes and msg is NULL when the message is held in those bytes. Use
+ * at_cmd_parser_get_msg() and at_cmd_parser_free_msg() to handle either kind of entry.
  */
 
 typedef struct
 {
-    at_cmd_msg_base_t *msg;         /**< Pointer to command message */
+    at_cmd_msg_base_t *msg;         /**< Pointer to command message, NULL for an inline message */
 } at_cmd_msg_queue_t;
 
+/**
+ * Retransmit cache statistics.
+ */
+
+typedef struct
+{
+    uint32_t hits;                  /**< Retransmitted commands answered from the cache          */
+    uint32_t misses;                /**< Commands not found in the cache                          */
+    uint32_t drops;                 /**< Retransmitted commands dropped because they were in flight */
+} at_cmd_retransmit_stats_t;
+
+/**
+ * Diagnostic counters measured by the library. See at_cmd_parser_get_diag_stats().
+ */
+
+typedef struct
+{
+    uint32_t rx_bytes;              /**< Bytes read from the transport                    */
+    uint32_t rx_reads;              /**< Reads that returned data                         */
+    uint32_t rx_frames;             /**< Command frames received                          */
+    uint32_t tx_bytes;              /**< Bytes written to the transport                   */
+    uint32_t tx_frames;             /**< Frames written to the transport                  */
+    uint32_t elapsed_ms;            /**< Time since the counters were reset               */
+} at_cmd_diag_stats_t;
+
+/**
+ * Memory used by the library as built. See at_cmd_parser_get_footprint().
+ */
+
+typedef struct
+{
+    uint32_t profile;               /**< AT_CMD_PROFILE the library was built with        */
+    uint32_t static_ram;            /**< Bytes of static parser state                     */
+    uint32_t buffer_size;           /**< Bytes in each command and output buffer          */
+    uint32_t max_cmd_size;          /**< Largest command or response data in bytes        */
+    uint32_t thread_stacks;         /**< Bytes of stack for the threads created by
+                                         at_cmd_parser_init()                             */
+} at_cmd_footprint_t;
+
+/**
+ * Response builder.
+ *
+ * Used with at_cmd_parser_response_begin() or at_cmd_parser_async_response_begin() to format a
+ * response directly into the library output buffer. The fields are internal to the library
+ * and must not be accessed by the application.
+ */
+
+typedef struct
+{
+    char                    *buffer;        /**< Output frame being built                          */
+    uint32_t                size;           /**< Space available for the frame                     */
+    uint32_t                len;            /**< Current frame length                              */
+    uint32_t                data_start;     /**< Offset of the data counted in the frame length    */
+    at_cmd_output_class_t   output_class;   /**< Output class of the frame                         */
+    uint32_t                output_index;   /**< Output buffer holding the frame                   */
+    bool                    sep_pending;    /**< Separator needed before the first text            */
+    bool                    need_comma;     /**< JSON value separator needed before the next value */
+    bool                    overflow;       /**< The frame did not fit in the output buffer        */
+    uint32_t                serial;         /**< Serial number of a status response                */
+    uint32_t                status;         /**< Status value of a status response                 */
+    uint32_t                status_end;     /**< Offset just past the status value                 */
+} at_cmd_response_t;
+
 /** \} group_at_cmd_parser_structures */
 
 /**
@@ -163,6 +292,82 @@ typedef struct
 
 typedef at_cmd_msg_base_t * (*at_cmd_parser_callback_t)(uint32_t cmd_id, uint32_t serial, uint32_t cmd_args_len, uint8_t *cmd_args);
 
+/** Binary command callback prototype.
+ *
+ * Called for commands sent with the AT+B header. The data is passed exactly as it was
+ * received and may contain any byte values.
+ *
+ * @param[in] cmd_id   : Command id of the command
+ * @param[in] serial   : Serial number of the command
+ * @param[in] data     : Pointer to the command data
+ * @param[in] data_len : Length of the command data in bytes
+ *
+ * @return Pointer to allocated message structure or NULL
+ */
+
+typedef at_cmd_msg_base_t * (*at_cmd_binary_callback_t)(uint32_t cmd_id, uint32_t serial, uint8_t *data, uint32_t data_len);
+
+/** Inline message command callback prototype.
+ *
+ * Used instead of at_cmd_parser_callback_t by commands whose messages usually fit in a
+ * message queue entry. The callback builds the message in inline_msg and returns inline_msg,
+ * so the message is copied into the queue entry without using the heap. A message that does
+ * not fit is allocated and returned as with at_cmd_parser_callback_t.
+ *
+ * @param[in] cmd_id       : Command id of the command
+ * @param[in] serial       : Serial number of the command
+ * @param[in] cmd_args_len : Length of the argument command string
+ * @param[in] cmd_args     : Argument command string
+ * @param[in] inline_msg   : Space for an inline message, NULL if inline messages are not enabled
+ * @param[in] inline_size  : Size of the inline message space in bytes
+ *
+ * @return inline_msg, a pointer to an allocated message structure, or NULL
+ */
+
+typedef at_cmd_msg_base_t * (*at_cmd_inline_callback_t)(uint32_t cmd_id, uint32_t serial, uint32_t cmd_args_len, uint8_t *cmd_args,
+                                                        at_cmd_msg_base_t *inline_msg, uint32_t inline_size);
+
+/** Streaming command begin callback prototype.
+ *
+ * Called when the header of a streamed command has been received, before any of the data.
+ * It is not called for a retransmitted command or a command refused by its limits.
+ *
+ * @param[in]  cmd_id   : Command id of the command
+ * @param[in]  serial   : Serial number of the command
+ * @param[in]  data_len : Total number of data bytes that will follow
+ * @param[out] context  : Application context passed to the data and end callbacks
+ *
+ * @return CY_RSLT_SUCCESS to accept the command. Any other value rejects it and the data is discarded.
+ */
+
+typedef cy_rslt_t (*at_cmd_stream_begin_t)(uint32_t cmd_id, uint32_t serial, uint32_t data_len, void **context);
+
+/** Streaming command data callback prototype.
+ *
+ * Called with each piece of command data as it is read from the transport. The data is only
+ * valid during the call.
+ *
+ * @param[in] context : Application context from the begin callback
+ * @param[in] data    : Pointer to the data
+ * @param[in] len     : Length of the data in bytes
+ *
+ * @return CY_RSLT_SUCCESS to continue. Any other value aborts the command.
+ */
+
+typedef cy_rslt_t (*at_cmd_stream_data_t)(void *context, uint8_t *data, uint32_t len);
+
+/** Streaming command end callback prototype.
+ *
+ * Called once for every accepted command, after the last of the data or when the command is aborted.
+ *
+ * @param[in] context  : Application context from the begin callback
+ * @param[in] complete : true if all of the data was received, false if the command was aborted
+ *
+ * @return Pointer to allocated message structure or NULL. The message is only delivered for a complete command.
+ */
+
+typedef at_cmd_msg_base_t * (*at_cmd_stream_end_t)(void *context, bool complete);
+
 /** \} group_at_cmd_parser_typedefs */
 
 /**
@@ -170,6 +375,44 @@ typedef at_cmd_msg_base_t * (*at_cmd_parser_callback_t)(uint32_t cmd_id, uint32_
  * \{
  */
 
+/**
+ * Streaming command callbacks.
+ */
+
+typedef struct
+{
+    at_cmd_stream_begin_t       begin;              /**< Start of a streamed command        */
+    at_cmd_stream_data_t        data;               /**< Command data as it arrives         */
+    at_cmd_stream_end_t         end;                /**< End of a streamed command          */
+} at_cmd_stream_callbacks_t;
+
+/**
+ * Admission limits for a command.
+ *
+ * Commands refused by their limits are answered with AT_CMD_STATUS_BUSY before
+ * the command callback is run. The limits are copied when the command table is
+ * registered and the library keeps its own state for them, so the structure can be const.
+ */
+
+typedef struct
+{
+    uint32_t                    max_in_flight;      /**< Commands accepted and not yet answered with a
+                                                         status response, 0 for no limit                 */
+    uint32_t                    rate;               /**< Commands accepted per second, 0 for no limit    */
+    uint32_t                    burst;              /**< Commands accepted back to back before the rate
+                                                         applies, at least 1                             */
+} at_cmd_limits_t;
+
+/**
+ * Admission limit statistics. See at_cmd_parser_get_limit_stats().
+ */
+
+typedef struct
+{
+    uint32_t in_flight;             /**< Commands accepted and not yet answered                   */
+    uint32_t rejected;              /**< Commands refused since the limits were registered        */
+} at_cmd_limit_stats_t;
+
 /**
  * Command table entry.
  */
@@ -179,6 +422,18 @@ typedef struct
     char                        *cmd_name;          /**< String command name                */
     uint32_t                    cmd_id;             /**< Command identifier for the command */
     at_cmd_parser_callback_t    cmd_parser;         /**< Parser callback for the command    */
+    uint32_t                    cmd_class;          /**< Routing class for the command message, less than
+                                                         AT_CMD_MAX_CMD_CLASSES. 0 is the default class. */
+    const at_cmd_stream_callbacks_t *stream_callbacks;
+                                                    /**< Optional callbacks for streamed commands. If set,
+                                                         the command can be sent with the AT+L header and
+                                                         its data is passed on as it arrives.             */
+    at_cmd_binary_callback_t    binary_parser;      /**< Optional callback for binary commands sent with
+                                                         the AT+B header                                  */
+    at_cmd_inline_callback_t    inline_parser;      /**< Optional callback used instead of cmd_parser that
+                                                         can build the message in the queue entry       */
+    const at_cmd_limits_t       *limits;            /**< Optional admission limits for the command. Used
+                                                         when AT_CMD_LIMIT_ENTRIES is greater than 0.     */
 } at_cmd_def_t;
 
 /** \} group_at_cmd_parser_structures */
@@ -227,6 +482,26 @@ typedef uint32_t (*at_cmd_transport_read_data)(uint8_t *buffer, uint32_t size, v
  */
 typedef cy_rslt_t (*at_cmd_transport_write_data)(uint8_t *buffer, uint32_t length, void *opaque);
 
+/*
+ * An asynchronous write function uses the same prototype as at_cmd_transport_write_data.
+ * It starts the write and returns without waiting for it to finish. The buffer remains
+ * valid until the transport calls at_cmd_parser_write_complete(). Only one asynchronous
+ * write is started at a time.
+ */
+
+/** Transport layer flow control function prototype.
+ *
+ * Routine is called by the AT Command Parser library when the command message queue
+ * fills up and again when space becomes available. The transport should stop the host
+ * from sending, for example by deasserting RTS or sending XOFF, while input is stopped.
+ * The library does not read any input while input is stopped.
+ *
+ * @param[in] stop   : true to stop input from the host, false to resume it.
+ * @param[in] opaque : Optional opaque pointer passed to the library during initialization.
+ */
+
+typedef void (*at_cmd_transport_flow_control)(bool stop, void *opaque);
+
 /** \} group_at_cmd_parser_typedefs */
 
 /**
@@ -240,10 +515,32 @@ typedef cy_rslt_t (*at_cmd_transport_write_data)(uint8_t *buffer, uint32_t lengt
 typedef struct
 {
     cy_queue_t                      *cmd_msg_queue;     /**< Pointer to the initialized message queue */
-    at_cmd_transport_is_data_ready  is_data_ready;      /**< Pointer to is data ready function        */
+    at_cmd_transport_is_data_ready  is_data_ready;      /**< Pointer to is data ready function. NULL along
+                                                             with read_data if the application passes
+                                                             input with at_cmd_parser_input()           */
     at_cmd_transport_read_data      read_data;          /**< Pointer to read data function            */
     at_cmd_transport_write_data     write_data;         /**< Pointer to write data function           */
     void                            *opaque;            /**< Opaque application pointer               */
+    at_cmd_transport_flow_control   flow_control;       /**< Optional pointer to flow control function */
+    at_cmd_transport_write_data     write_data_async;   /**< Optional pointer to an asynchronous write
+                                                             function. If set it is used instead of
+                                                             write_data for output frames.              */
+    bool                            advertise_credits;  /**< Send Credits messages to the host with the
+                                                             number of free command queue entries as it
+                                                             changes, at most one every
+                                                             AT_CMD_CREDITS_MIN_INTERVAL_MS             */
+    cy_queue_t                      *class_msg_queue[AT_CMD_MAX_CMD_CLASSES];
+                                                        /**< Optional message queues for command classes.
+                                                             Messages for commands of class n are sent to
+                                                             class_msg_queue[n] if set, otherwise to
+                                                             cmd_msg_queue.                             */
+    uint32_t                        inline_msg_size;    /**< Bytes of inline message space after each queue
+                                                             entry, from sizeof(at_cmd_msg_base_t) up to
+                                                             AT_CMD_MAX_INLINE_MSG_SIZE. 0 for pointer
+                                                             messages only. If set, every message
+                                                             queue must be created with entries of
+                                                             AT_CMD_MSG_QUEUE_ENTRY_SIZE(inline_msg_size)
+                                                             bytes.                                     */
 } at_cmd_params_t;
 
 /** \} group_at_cmd_parser_structures */
@@ -270,6 +567,36 @@ typedef struct
 cy_rslt_t at_cmd_parser_init(at_cmd_params_t *params);
 
 
+/** Pass input received from the host to the library.
+ *
+ * Used instead of the input thread when is_data_ready and read_data are NULL in the
+ * initialization parameters, for example by an application that waits for input on
+ * a file descriptor in its own event loop. The data is parsed and any complete commands
+ * are dispatched before the call returns.
+ *
+ * The call does not wait for space in the command queue. A command that doesn't fit is
+ * answered with a busy status. The call can still block:
+ * - while a response, framing error or Credits message is written with a synchronous
+ *   write_data function, or while every output buffer is in use with write_data_async.
+ *   Framing errors and Credits messages are written by the error thread instead when the
+ *   library is built with AT_CMD_ERROR_EVENTS set.
+ * - when the library is built with AT_CMD_NUM_WORKERS set and all AT_CMD_WORKER_JOBS
+ *   commands are still in progress.
+ *
+ * \note The library has a single instance, so it serves one input source. An instance based
+ *       API for serving many links from one event loop is not available yet. Only one thread
+ *       may pass input to the library.
+ *
+ * @param[in] data : Pointer to the input data.
+ * @param[in] len  : Length of the input data in bytes.
+ *
+ * @return    Number of bytes consumed. 0 while the command queue is full and input is
+ *            stopped by flow control, in which case the caller should offer the data again later.
+ */
+
+uint32_t at_cmd_parser_input(uint8_t *data, uint32_t len);
+
+
 /** Register a command table with the AT Command Parser library.
  *
  * \note The library stores a reference to the command table so the table
@@ -284,6 +611,40 @@ cy_rslt_t at_cmd_parser_init(at_cmd_params_t *params);
 cy_rslt_t at_cmd_parser_register_commands(at_cmd_def_t *cmd_table, uint32_t num_cmds);
 
 
+/** Unregister a command table from the AT Command Parser library.
+ *
+ * Tables may be registered and unregistered at any time, including while
+ * commands are being received. Command lookups never wait for a table change.
+ *
+ * \note Once this returns the library no longer references the command table,
+ * although callbacks for commands found before the call may still be running.
+ * This function must not be called from a command callback.
+ *
+ * @param[in] cmd_table : Pointer to the command table to be unregistered.
+ *
+ * @return    Status of the operation. CY_AT_CMD_PARSER_BAD_PARAM if the table is not registered.
+ */
+
+cy_rslt_t at_cmd_parser_unregister_commands(at_cmd_def_t *cmd_table);
+
+
+/** Replace a registered command table with another in a single step.
+ *
+ * Each command lookup sees either the old table or the new table, never neither.
+ * The new table takes the place of the old table in the lookup order.
+ *
+ * \note The same restrictions as at_cmd_parser_unregister_commands() apply to the old table.
+ *
+ * @param[in] old_table : Pointer to the registered command table to replace.
+ * @param[in] new_table : Pointer to the new command table.
+ * @param[in] num_cmds  : Number of entries in the new command table.
+ *
+ * @return    Status of the operation. CY_AT_CMD_PARSER_BAD_PARAM if the old table is not registered.
+ */
+
+cy_rslt_t at_cmd_parser_swap_commands(at_cmd_def_t *old_table, at_cmd_def_t *new_table, uint32_t num_cmds);
+
+
 /** Send a command response message.
  *
  * @param[in] serial : Serial number for the message
@@ -306,6 +667,333 @@ cy_rslt_t at_cmd_parser_send_cmd_response(uint32_t serial, uint32_t status, char
 
 cy_rslt_t at_cmd_parser_send_cmd_async_response(uint32_t serial, char *text);
 
+
+/** Send a compressed asynchronous command response message.
+ *
+ * The text is sent in a +Z frame when the library is built with ENABLE_AT_CMD_COMPRESSION
+ * and compression reduces the message size. Otherwise the message is sent as a regular +H frame.
+ *
+ * @param[in] serial : Serial number for the message
+ * @param[in] text   : Text to include in the response message
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_parser_send_cmd_async_response_compressed(uint32_t serial, char *text);
+
+
+/** Enable or disable compression for all asynchronous command response messages.
+ *
+ * Typically called by the application once the host has indicated that it
+ * can decode +Z frames.
+ *
+ * @param[in] enable : true to compress asynchronous messages, false to send them uncompressed
+ *
+ * @return    CY_AT_CMD_PARSER_UNSUPPORTED if the library was built without ENABLE_AT_CMD_COMPRESSION.
+ */
+
+cy_rslt_t at_cmd_parser_enable_async_compression(bool enable);
+
+
+/** Limit the output bandwidth used by a class of messages.
+ *
+ * Senders of a rate limited class are delayed until the class has bandwidth available.
+ * Short bursts up to AT_CMD_OUTPUT_BURST_MS worth of data are allowed.
+ *
+ * @param[in] output_class  : Output message class to limit
+ * @param[in] bytes_per_sec : Maximum average rate in bytes per second. 0 removes the limit.
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_parser_set_output_bandwidth(at_cmd_output_class_t output_class, uint32_t bytes_per_sec);
+
+
+/** Report that an asynchronous write has finished.
+ *
+ * Called by the transport when the write started by the write_data_async function
+ * completes. The output buffer is released and the next queued frame, if any, is
+ * started before this returns.
+ *
+ * \note This function uses a mutex and must be called from thread context. Transports
+ * that complete writes in an interrupt should defer the call to a thread.
+ *
+ * @param[in] result : Result of the write operation.
+ *
+ * @return    Status of the operation. CY_AT_CMD_PARSER_ERROR if no write is in progress.
+ */
+
+cy_rslt_t at_cmd_parser_write_complete(cy_rslt_t result);
+
+
+/** Get the number of commands the host can send before the command message queue is full.
+ *
+ * Only the default queue, cmd_msg_queue, is considered.
+ *
+ * The application can include the value in its responses so that the host can keep
+ * the command pipeline full without overrunning it.
+ *
+ * @param[out] credits : Number of free entries in the command message queue.
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_parser_get_credits(uint32_t *credits);
+
+
+/** Check whether the deadline of a command has passed.
+ *
+ * The library drops commands whose deadline has passed before they are queued. The application
+ * can call this before running a command taken from the queue. If the deadline has passed, the
+ * command is answered with AT_CMD_STATUS_TIMEOUT and the application should free the message
+ * without running it.
+ *
+ * @param[in] msg : Pointer to the command message.
+ *
+ * @return    true if the deadline has passed and the timeout response was sent.
+ */
+
+bool at_cmd_parser_check_deadline(at_cmd_msg_base_t *msg);
+
+
+/** Get the command message from a message queue entry.
+ *
+ * \note An inline message is only valid as long as the queue entry it was read into.
+ *
+ * @param[in] entry : Pointer to the queue entry read from the message queue.
+ *
+ * @return    Pointer to the command message.
+ */
+
+at_cmd_msg_base_t *at_cmd_parser_get_msg(at_cmd_msg_queue_t *entry);
+
+
+/** Free the command message in a message queue entry.
+ *
+ * An allocated message is freed. Nothing needs to be freed for an inline message.
+ *
+ * @param[in] entry : Pointer to the queue entry read from the message queue.
+ */
+
+void at_cmd_parser_free_msg(at_cmd_msg_queue_t *entry);
+
+
+/** Get the retransmit cache statistics.
+ *
+ * The retransmit cache is enabled by defining AT_CMD_RETRANSMIT_CACHE_ENTRIES to a non-zero value.
+ * A command with the same serial number as a command received within the last
+ * AT_CMD_RETRANSMIT_WINDOW_MS milliseconds is not dispatched again. If the response for the
+ * original command has been sent it is sent again, otherwise the retransmitted command is dropped.
+ * Serial number 0 is never cached.
+ *
+ * @param[out] stats : Pointer to the structure to receive the statistics.
+ *
+ * @return    CY_AT_CMD_PARSER_UNSUPPORTED if the retransmit cache is not enabled.
+ */
+
+cy_rslt_t at_cmd_parser_get_retransmit_stats(at_cmd_retransmit_stats_t *stats);
+
+
+/** Get the statistics of registered admission limits.
+ *
+ * Command limits are enabled by defining AT_CMD_LIMIT_ENTRIES to a non-zero value.
+ * Commands that share an at_cmd_limits_t structure share its statistics.
+ *
+ * @param[in]  limits : Limits used by a registered command table entry.
+ * @param[out] stats  : Pointer to the structure to receive the statistics.
+ *
+ * @return    CY_AT_CMD_PARSER_BAD_PARAM if the limits are not registered,
+ *            CY_AT_CMD_PARSER_UNSUPPORTED if command limits are not enabled.
+ */
+
+cy_rslt_t at_cmd_parser_get_limit_stats(const at_cmd_limits_t *limits, at_cmd_limit_stats_t *stats);
+
+
+/** Register the diagnostic command table.
+ *
+ * The diagnostic commands are built when ENABLE_AT_CMD_DIAGNOSTICS is defined. They are run by
+ * the library and never queued for the application, so they measure the transport and the parser
+ * on their own. No input is read while a diagnostic command runs.
+ *
+ * - DiagEcho[,Text] : Responds with the command text.
+ * - DiagSink[,Data] : Responds with no text. May also be sent as a binary command.
+ * - DiagSource,{"bytes":N[,"size":S]} : Sends +H DiagData messages carrying N bytes of payload,
+ *   S bytes per message, as fast as the transport accepts them. Then responds with the bytes,
+ *   messages, elapsed milliseconds and rates.
+ * - DiagStats[,{"reset":true}] : Responds with the counters from at_cmd_parser_get_diag_stats()
+ *   and the byte and frame rates, and optionally resets the counters.
+ *
+ * @return    CY_AT_CMD_PARSER_UNSUPPORTED if the diagnostic commands are not enabled.
+ */
+
+cy_rslt_t at_cmd_parser_register_diag_commands(void);
+
+
+/** Unregister the diagnostic command table.
+ *
+ * @return    CY_AT_CMD_PARSER_UNSUPPORTED if the diagnostic commands are not enabled.
+ */
+
+cy_rslt_t at_cmd_parser_unregister_diag_commands(void);
+
+
+/** Get the diagnostic counters.
+ *
+ * The counters are kept when ENABLE_AT_CMD_DIAGNOSTICS is defined and count from
+ * at_cmd_parser_init() or the last DiagStats reset.
+ *
+ * @param[out] stats : Pointer to the structure to receive the counters.
+ *
+ * @return    CY_AT_CMD_PARSER_UNSUPPORTED if the diagnostic commands are not enabled.
+ */
+
+cy_rslt_t at_cmd_parser_get_diag_stats(at_cmd_diag_stats_t *stats);
+
+
+/** Get the memory used by the library.
+ *
+ * Reports the static RAM and thread stacks that the build options and profile
+ * selected, so that changes in the memory cost of a build can be tracked.
+ * The thread stacks are only known after at_cmd_parser_init() is called.
+ *
+ * @param[out] footprint : Pointer to the structure to receive the memory use.
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_parser_get_footprint(at_cmd_footprint_t *footprint);
+
+
+/** Begin building a command response message in place.
+ *
+ * The output is reserved for the caller until at_cmd_parser_response_send() or
+ * at_cmd_parser_response_cancel() is called. The builder functions write directly into the
+ * output frame so no intermediate string or printf formatting is needed.
+ *
+ * @param[out] rsp    : Pointer to the response builder.
+ * @param[in]  serial : Serial number for the message
+ * @param[in]  status : Status value for the message
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_parser_response_begin(at_cmd_response_t *rsp, uint32_t serial, uint32_t status);
+
+
+/** Begin building an asynchronous message in place.
+ *
+ * @param[out] rsp      : Pointer to the response builder.
+ * @param[in]  serial   : Serial number for the message
+ * @param[in]  msg_name : Name of the message. For example: "ScanResult"
+ *
+ * @return    Status of the operation.
+ */
+
+cy_rslt_t at_cmd_parser_async_response_begin(at_cmd_response_t *rsp, uint32_t serial, const char *msg_name);
+
+
+/** Finish the message, fill in the length and send it to the host.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ *
+ * @return    CY_AT_CMD_PARSER_BUFFER_OVERFLOW if the message did not fit in the output buffer.
+ *            Nothing is sent in that case.
+ */
+
+cy_rslt_t at_cmd_parser_response_send(at_cmd_response_t *rsp);
+
+
+/** Discard the message and release the output.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ */
+
+void at_cmd_parser_response_cancel(at_cmd_response_t *rsp);
+
+
+/** Append text to the message as is.
+ *
+ * @param[in] rsp  : Pointer to the response builder.
+ * @param[in] text : Text to append.
+ * @param[in] len  : Length of the text in bytes.
+ */
+
+void at_cmd_parser_response_append(at_cmd_response_t *rsp, const char *text, uint32_t len);
+
+
+/** Start a JSON object.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ * @param[in] key : Member name if the object is a member of an enclosing object, NULL otherwise.
+ */
+
+void at_cmd_parser_json_object_begin(at_cmd_response_t *rsp, const char *key);
+
+
+/** End a JSON object.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ */
+
+void at_cmd_parser_json_object_end(at_cmd_response_t *rsp);
+
+
+/** Start a JSON array.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ * @param[in] key : Member name if the array is a member of an enclosing object, NULL otherwise.
+ */
+
+void at_cmd_parser_json_array_begin(at_cmd_response_t *rsp, const char *key);
+
+
+/** End a JSON array.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ */
+
+void at_cmd_parser_json_array_end(at_cmd_response_t *rsp);
+
+
+/** Add a JSON string value. The value is escaped as needed.
+ *
+ * @param[in] rsp   : Pointer to the response builder.
+ * @param[in] key   : Member name, or NULL for an array element.
+ * @param[in] value : Nul terminated string value.
+ */
+
+void at_cmd_parser_json_add_string(at_cmd_response_t *rsp, const char *key, const char *value);
+
+
+/** Add a JSON signed integer value.
+ *
+ * @param[in] rsp   : Pointer to the response builder.
+ * @param[in] key   : Member name, or NULL for an array element.
+ * @param[in] value : Integer value.
+ */
+
+void at_cmd_parser_json_add_int(at_cmd_response_t *rsp, const char *key, int32_t value);
+
+
+/** Add a JSON unsigned integer value.
+ *
+ * @param[in] rsp   : Pointer to the response builder.
+ * @param[in] key   : Member name, or NULL for an array element.
+ * @param[in] value : Integer value.
+ */
+
+void at_cmd_parser_json_add_uint(at_cmd_response_t *rsp, const char *key, uint32_t value);
+
+
+/** Add a JSON boolean value.
+ *
+ * @param[in] rsp   : Pointer to the response builder.
+ * @param[in] key   : Member name, or NULL for an array element.
+ * @param[in] value : Boolean value.
+ */
+
+void at_cmd_parser_json_add_bool(at_cmd_response_t *rsp, const char *key, bool value);
+
 /** \} group_at_cmd_parser_functions */
 #ifdef __cplusplus
 }
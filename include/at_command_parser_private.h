@@ -42,6 +42,8 @@
 extern "C" {
 #endif
 
+#include <stdatomic.h>
+
 #include "at_command_parser.h"
 
 /******************************************************
@@ -52,7 +54,9 @@ extern "C" {
  *                    Constants
  ******************************************************/
 
+#ifndef AT_CMD_PARSER_BUFFER_SIZE
 #define AT_CMD_PARSER_BUFFER_SIZE           (6*1024+40)
+#endif
 
 #define AT_CMD_PREFIX                       "AT+"
 
@@ -62,58 +66,556 @@ extern "C" {
 #define AT_CMD_MIN_HEADER_SIZE              (AT_CMD_PREFIX_CHARS + AT_CMD_SIZE_CHARS + 1)
 
 #define AT_CMD_TERMINATOR_CHAR              ';'
+#define AT_CMD_DEADLINE_CHAR                '@'     /* Separates the serial number from an optional deadline */
+
+#define AT_CMD_BINARY_MARKER_CHAR           'B'     /* Follows the prefix of a binary command               */
+#define AT_CMD_STREAM_MARKER_CHAR           'L'     /* Follows the prefix of a streamed command             */
+#define AT_CMD_STREAM_SIZE_CHARS            (8)     /* 8 digit data size for streamed commands              */
+#define AT_CMD_STREAM_MAX_NAME              (64)    /* Longest command name accepted for a streamed command */
+
+#ifndef AT_CMD_NUM_CHANNELS
+#define AT_CMD_NUM_CHANNELS                 (1)     /* Logical input channels, channel 0 is the transport itself */
+#endif
+
+#define AT_CMD_CHANNEL_CHAR                 '%'     /* Replaces '+' in the prefix of a channel chunk frame       */
+
+#ifndef AT_CMD_MAX_SIZE
+#define AT_CMD_MAX_SIZE                     (6000)  /* Largest command or response data, at most 4 digits */
+#endif
+
+#define AT_CMD_OUTPUT_MAX_WAITERS           (16)    /* Maximum threads waiting to send per output class */
+
+#ifndef AT_CMD_NUM_OUTPUT_BUFFERS
+#define AT_CMD_NUM_OUTPUT_BUFFERS           (1)     /* Output frames that can be built or in flight at once.
+                                                       Only used with an asynchronous write function.    */
+#endif
+
+#ifndef AT_CMD_OUTPUT_BURST_MS
+#define AT_CMD_OUTPUT_BURST_MS              (100)   /* Burst allowance for rate limited output classes  */
+#endif
+
+#define AT_CMD_CREDITS_MSG_NAME             "Credits"
+
+#ifndef AT_CMD_RETRANSMIT_CACHE_ENTRIES
+#define AT_CMD_RETRANSMIT_CACHE_ENTRIES     (0)     /* Number of cached responses, 0 disables the cache */
+#endif
+
+#ifndef AT_CMD_RETRANSMIT_CACHE_TEXT_SIZE
+#define AT_CMD_RETRANSMIT_CACHE_TEXT_SIZE   (64)    /* Longer response text is not cached               */
+#endif
+
+#ifndef AT_CMD_RETRANSMIT_WINDOW_MS
+#define AT_CMD_RETRANSMIT_WINDOW_MS         (10000)
+#endif
+
+#ifndef AT_CMD_NUM_WORKERS
+#define AT_CMD_NUM_WORKERS                  (0)     /* Threads running command callbacks, 0 runs them on the input thread */
+#endif
+
+#ifndef AT_CMD_WORKER_JOBS
+#define AT_CMD_WORKER_JOBS                  (AT_CMD_NUM_WORKERS + 1)    /* Commands that can be in progress at once */
+#endif
+
+#ifndef AT_CMD_WORKER_STACK_SIZE
+#define AT_CMD_WORKER_STACK_SIZE            (4*1024)
+#endif
+
+#ifndef AT_CMD_LIMIT_ENTRIES
+#define AT_CMD_LIMIT_ENTRIES                (0)     /* Limited commands tracked while in flight and limits that can be
+                                                       registered, 0 disables command limits */
+#endif
+
+#ifndef AT_CMD_ERROR_EVENTS
+#define AT_CMD_ERROR_EVENTS                 (0)     /* Framing errors held for the error thread, 0 sends them from the input thread */
+#endif
+
+#ifndef AT_CMD_ERROR_MIN_INTERVAL_MS
+#define AT_CMD_ERROR_MIN_INTERVAL_MS        (10)    /* Minimum time between error responses, repeats are coalesced  */
+#endif
+
+#ifndef AT_CMD_CREDITS_MIN_INTERVAL_MS
+#define AT_CMD_CREDITS_MIN_INTERVAL_MS      (10)    /* Minimum time between Credits messages, changes are coalesced */
+#endif
+
+#ifndef AT_CMD_ERROR_STACK_SIZE
+#define AT_CMD_ERROR_STACK_SIZE             (2*1024)
+#endif
+
+#ifndef AT_CMD_BATCH_MAX_ENTRIES
+#define AT_CMD_BATCH_MAX_ENTRIES            (0)     /* Commands allowed in a batch, 0 disables batch commands */
+#endif
+
+#ifndef AT_CMD_MAX_BATCHES
+#define AT_CMD_MAX_BATCHES                  (2)     /* Batches that can be waiting for responses at once      */
+#endif
+
+#ifndef AT_CMD_BATCH_RESPONSE_SIZE
+#define AT_CMD_BATCH_RESPONSE_SIZE          (512)   /* Space for the combined batch response text             */
+#endif
+
+#define AT_CMD_BATCH_CMD_NAME               "Batch"
+#define AT_CMD_BATCH_SEPARATOR              '\x1e' /* ASCII record separator, never valid inside JSON text   */
+
+#if AT_CMD_MAX_INLINE_MSG_SIZE > 0
+#define AT_CMD_INLINE_BUFFER_SIZE           AT_CMD_MAX_INLINE_MSG_SIZE
+#else
+#define AT_CMD_INLINE_BUFFER_SIZE           (1)
+#endif
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+#define AT_CMD_PARSE_MAX_MSGS               AT_CMD_BATCH_MAX_ENTRIES
+#else
+#define AT_CMD_PARSE_MAX_MSGS               (1)
+#endif
+
+/*
+ * Threads that look up commands: the input thread and the worker threads.
+ */
 
-#define AT_CMD_MAX_SIZE                     (6000)
+#define AT_CMD_TABLE_READERS                (AT_CMD_NUM_WORKERS + 1)
+#define AT_CMD_TABLE_READER_INPUT           (0)
+
+#define AT_CMD_TRAILER_CHARS                (4)     /* ;\r\n and the trailing nul   */
+
+#define AT_CMD_STATUS_MSG_TYPE              'S'
+#define AT_CMD_ASYNC_MSG_TYPE               'H'
+#define AT_CMD_COMPRESSED_MSG_TYPE          'Z'
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+#ifndef AT_CMD_DIAG_DEFAULT_FRAME_SIZE
+#define AT_CMD_DIAG_DEFAULT_FRAME_SIZE      (256)   /* DiagSource payload bytes per frame when not given    */
+#endif
+
+#ifndef AT_CMD_DIAG_MAX_SOURCE_BYTES
+#define AT_CMD_DIAG_MAX_SOURCE_BYTES        (64 * 1024) /* Largest DiagSource request, input is paused while it runs */
+#endif
+
+#define AT_CMD_DIAG_MAX_FRAME_SIZE          (AT_CMD_MAX_SIZE - 32)
+#define AT_CMD_DIAG_NUM_CMDS                (4)
+
+#define AT_CMD_DIAG_CMD_ID_ECHO             (AT_CMD_DIAG_CMD_ID_BASE + 0)
+#define AT_CMD_DIAG_CMD_ID_SINK             (AT_CMD_DIAG_CMD_ID_BASE + 1)
+#define AT_CMD_DIAG_CMD_ID_SOURCE           (AT_CMD_DIAG_CMD_ID_BASE + 2)
+#define AT_CMD_DIAG_CMD_ID_STATS            (AT_CMD_DIAG_CMD_ID_BASE + 3)
+#endif
+
+#ifdef ENABLE_AT_CMD_COMPRESSION
+#ifndef AT_CMD_COMPRESS_HASH_BITS
+#define AT_CMD_COMPRESS_HASH_BITS           (10)    /* Match finder hash table has 2^N entries  */
+#endif
+
+#ifndef AT_CMD_COMPRESS_WINDOW_SIZE
+#define AT_CMD_COMPRESS_WINDOW_SIZE         (4096)  /* Maximum match distance in bytes          */
+#endif
+
+#ifndef AT_CMD_COMPRESS_MIN_SIZE
+#define AT_CMD_COMPRESS_MIN_SIZE            (64)    /* Smaller messages are sent uncompressed   */
+#endif
+#endif
 
 /******************************************************
  *                   Enumerations
  ******************************************************/
 
+typedef enum
+{
+    AT_CMD_RETRANSMIT_FREE = 0,
+    AT_CMD_RETRANSMIT_IN_FLIGHT,
+    AT_CMD_RETRANSMIT_COMPLETE
+} at_cmd_retransmit_state_t;
+
+typedef enum
+{
+    AT_CMD_JOB_FREE = 0,
+    AT_CMD_JOB_PENDING,             /* Waiting for or running on a worker thread    */
+    AT_CMD_JOB_DONE                 /* Waiting to be delivered in order             */
+} at_cmd_job_state_t;
+
+typedef enum
+{
+    AT_CMD_STREAM_NAME = 0,         /* Reading the command name                     */
+    AT_CMD_STREAM_DATA,             /* Passing data to the command                  */
+    AT_CMD_STREAM_DISCARD,          /* Skipping the data of a rejected command      */
+    AT_CMD_STREAM_TRAILER           /* Waiting for the trailing ';'                 */
+} at_cmd_stream_state_t;
+
+typedef enum
+{
+    AT_CMD_CHUNK_NONE = 0,          /* Not reading a channel chunk                  */
+    AT_CMD_CHUNK_CHANNEL,           /* Reading the channel number                   */
+    AT_CMD_CHUNK_SIZE,              /* Reading the chunk size                       */
+    AT_CMD_CHUNK_DATA               /* Passing the chunk data to the channel        */
+} at_cmd_chunk_state_t;
+
+typedef enum
+{
+    AT_CMD_OUTPUT_FREE = 0,
+    AT_CMD_OUTPUT_BUILDING,         /* Owned by a sender building a frame           */
+    AT_CMD_OUTPUT_QUEUED,           /* Waiting for the transport                    */
+    AT_CMD_OUTPUT_SENDING           /* Being written by the transport               */
+} at_cmd_output_state_t;
+
 /******************************************************
  *                 Type Definitions
  ******************************************************/
 
-typedef struct at_cmd_table_def_s
+typedef struct
 {
-    struct at_cmd_table_def_s *next;
     at_cmd_def_t *cmd_table;
     uint32_t num_cmds;
 } at_cmd_table_t;
 
+/*
+ * The registered command tables. A set is never modified once it is published,
+ * changes are made by publishing a new copy and freeing the old one once no
+ * readers can still be using it.
+ */
+
+typedef struct
+{
+    uint32_t num_tables;
+    at_cmd_table_t tables[];
+} at_cmd_table_set_t;
+
+typedef struct
+{
+    uint32_t    bytes_per_sec;      /* 0 if the class is not rate limited       */
+    int32_t     tokens;             /* Available bytes, negative when in debt   */
+    cy_time_t   last_refill;
+} at_cmd_output_rate_t;
+
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+typedef struct
+{
+    at_cmd_retransmit_state_t state;
+    uint32_t    serial;
+    cy_time_t   time;               /* Time the command was received or answered */
+    uint32_t    status;
+    char        text[AT_CMD_RETRANSMIT_CACHE_TEXT_SIZE];
+} at_cmd_retransmit_entry_t;
+#endif
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+typedef struct
+{
+    const at_cmd_limits_t *limits;  /* Registered limits, NULL if the state is free */
+    at_cmd_limits_t config;         /* Copy of the limits taken at registration     */
+    uint32_t in_flight;
+    uint32_t debt;                  /* Token bucket debt in thousandths of a command */
+    cy_time_t last_refill;
+    uint32_t rejected;
+} at_cmd_limit_state_t;
+
+typedef struct
+{
+    at_cmd_limit_state_t *state;    /* NULL if the entry is free                    */
+    uint32_t serial;
+    bool dispatched;                /* The application will answer the command      */
+} at_cmd_limit_entry_t;
+#endif
+
+/*
+ * Command reassembly state for an input channel.
+ */
+
+typedef struct
+{
+    bool reading_cmd;
+    bool cmd_header;
+    bool resyncing;
+    uint32_t resync_errors;         /* Framing errors found by the current rescan   */
+    const char *resync_error;       /* Text of the last of those errors             */
+    int at_cmd_prefix_idx;
+
+    uint8_t command_buffer[AT_CMD_PARSER_BUFFER_SIZE];
+    uint32_t cmd_widx;
+    uint32_t cmd_size;
+    uint32_t size_end;              /* Offset of the end of the size digits         */
+    bool binary;                    /* Reading a binary command                     */
+    bool deadline;                  /* Header has a deadline after the serial       */
+
+#ifdef ENABLE_AT_CMD_STREAMING
+    bool streaming;                 /* Reading a streamed command                   */
+    bool stream_open;               /* Begin callback accepted, end not yet called  */
+    at_cmd_stream_state_t stream_state;
+    uint32_t stream_serial;
+    uint32_t stream_remaining;      /* Bytes left before the trailing ';'           */
+    uint32_t stream_name;           /* Offset of the command name in the buffer     */
+    uint32_t stream_class;
+    uint32_t stream_timeout_ms;     /* Deadline given by the host, 0 if none        */
+    cy_time_t stream_rx_time;       /* Time the header was received                 */
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_entry_t *stream_limit;
+#endif
+    void *stream_context;
+    at_cmd_stream_callbacks_t stream;
+#endif
+} at_cmd_framer_t;
+
+typedef struct
+{
+    at_cmd_output_state_t state;
+    at_cmd_output_class_t output_class;
+    uint32_t seq;                   /* Order the frame was queued in                */
+    uint32_t len;
+    uint8_t buffer[AT_CMD_PARSER_BUFFER_SIZE];
+#ifdef ENABLE_AT_CMD_COMPRESSION
+    uint16_t compress_hash[1 << AT_CMD_COMPRESS_HASH_BITS];    /* Used by the sender building the frame */
+#endif
+} at_cmd_output_buffer_t;
+
+/*
+ * Space for an inline message, aligned for any message structure.
+ */
+
+typedef union
+{
+    at_cmd_msg_base_t base;
+    uint64_t align;
+    void *ptr;
+    uint8_t data[AT_CMD_INLINE_BUFFER_SIZE];
+} at_cmd_inline_msg_t;
+
+typedef union
+{
+    at_cmd_msg_queue_t entry;
+    uint8_t raw[AT_CMD_MSG_QUEUE_ENTRY_SIZE(AT_CMD_INLINE_BUFFER_SIZE)];
+} at_cmd_msg_queue_entry_t;
+
+typedef struct
+{
+    bool batch;                     /* Command was a batch of commands              */
+    uint32_t count;                 /* Number of messages, 0 for an invalid batch   */
+    at_cmd_msg_base_t *msg[AT_CMD_PARSE_MAX_MSGS];
+    uint32_t cmd_class[AT_CMD_PARSE_MAX_MSGS];
+    at_cmd_inline_msg_t inline_msg[AT_CMD_PARSE_MAX_MSGS];
+    const char *reject[AT_CMD_PARSE_MAX_MSGS];     /* Reason a command was refused by its limits */
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_entry_t *limit[AT_CMD_PARSE_MAX_MSGS]; /* In flight limit held by a command */
+#endif
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    bool diag[AT_CMD_PARSE_MAX_MSGS];                   /* Command is run by the library     */
+#endif
+    cy_time_t rx_time;              /* Time the command was received                */
+    uint32_t timeout_ms;            /* Deadline relative to rx_time, 0 for none     */
+} at_cmd_parse_result_t;
+
+#if AT_CMD_NUM_WORKERS > 0
+typedef struct
+{
+    at_cmd_job_state_t state;
+    uint32_t seq;                   /* Order the command was received in            */
+    uint32_t serial;
+    uint32_t len;
+    bool binary;
+    cy_time_t rx_time;
+    uint32_t timeout_ms;
+    at_cmd_parse_result_t result;
+    uint8_t buffer[AT_CMD_PARSER_BUFFER_SIZE];
+} at_cmd_job_t;
+#endif
+
+#if AT_CMD_ERROR_EVENTS > 0
+typedef struct
+{
+    uint32_t serial;
+    uint32_t count;                 /* Errors coalesced into this event             */
+    const char *text;               /* Text of the most recent error                */
+} at_cmd_error_event_t;
+#endif
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+typedef struct
+{
+    bool active;
+    uint32_t serial;
+    uint32_t pending;               /* Responses still to come                      */
+    uint32_t status;                /* First non-zero status of the batch           */
+    at_cmd_response_t rsp;          /* Builds the combined response text            */
+    char text[AT_CMD_BATCH_RESPONSE_SIZE];
+} at_cmd_batch_t;
+#endif
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+typedef struct
+{
+    atomic_uint rx_bytes;
+    atomic_uint rx_reads;
+    atomic_uint rx_frames;
+    atomic_uint tx_bytes;
+    atomic_uint tx_frames;
+    cy_time_t   start;              /* Time the counters were last reset            */
+} at_cmd_diag_counters_t;
+#endif
+
 typedef struct
 {
     cy_thread_t input_thread;
     cy_queue_t  *msg_queue;
+    cy_queue_t  *class_msg_queue[AT_CMD_MAX_CMD_CLASSES];
 
     at_cmd_transport_is_data_ready is_data_ready;
     at_cmd_transport_read_data     read_data;
     at_cmd_transport_write_data    write_data;
+    at_cmd_transport_write_data    write_data_async;
+    at_cmd_transport_flow_control  flow_control;
     void *opaque;
 
-    at_cmd_table_t *cmd_tables;
+    bool advertise_credits;
+    bool queue_full;
+    uint32_t credits_advertised;                        /* Last free entry count sent to the host */
+    uint32_t credits_pending;                           /* Count handed to the error thread to send */
+    cy_time_t credits_time;                             /* Time of the last attempt to send credits */
+    uint32_t inline_msg_size;
+
+    _Atomic(at_cmd_table_set_t *) cmd_tables;
+    atomic_uint table_epoch;                            /* Bumped each time a new table set is published */
+    atomic_uint table_reader_epoch[AT_CMD_TABLE_READERS];   /* Epoch seen by each reader, 0 when idle    */
+    atomic_uint table_next_reader;
+    cy_mutex_t table_mutex;                             /* Serializes table changes                      */
+    bool table_mutex_ready;
 
-    bool echo_cmd;
-    bool reading_cmd;
-    bool cmd_header;
     char at_cmd_prefix[AT_CMD_PREFIX_CHARS + 1];
-    int at_cmd_prefix_idx;
 
-    uint8_t command_buffer[AT_CMD_PARSER_BUFFER_SIZE];
-    uint32_t cmd_widx;
-    uint32_t cmd_size;
+    at_cmd_framer_t framer[AT_CMD_NUM_CHANNELS];
 
-    uint8_t output_buffer[AT_CMD_PARSER_BUFFER_SIZE];
+#if AT_CMD_NUM_CHANNELS > 1
+    at_cmd_chunk_state_t chunk_state;
+    uint32_t chunk_channel;
+    uint32_t chunk_size;                                /* Chunk data bytes still to come */
+    uint32_t chunk_digits;
+#endif
+
+    at_cmd_output_buffer_t output[AT_CMD_NUM_OUTPUT_BUFFERS];
     cy_mutex_t output_mutex;
+    uint32_t output_count;                              /* Output buffers in use                        */
+    uint32_t output_free;                               /* Free output buffers not promised to a waiter */
+    uint32_t output_seq;
+    bool output_sending;                                /* An asynchronous write is in progress         */
+    uint32_t output_waiting[AT_CMD_OUTPUT_CLASS_MAX];
+    cy_semaphore_t output_sem[AT_CMD_OUTPUT_CLASS_MAX];
+    at_cmd_output_rate_t output_rate[AT_CMD_OUTPUT_CLASS_MAX];
+
+#if AT_CMD_NUM_WORKERS > 0
+    cy_thread_t worker_thread[AT_CMD_NUM_WORKERS];
+    cy_queue_t job_queue;
+    cy_semaphore_t job_free_sem;
+    cy_mutex_t job_mutex;
+    at_cmd_job_t jobs[AT_CMD_WORKER_JOBS];
+    uint8_t job_order[AT_CMD_WORKER_JOBS];
+    uint32_t job_seq;
+    uint32_t deliver_seq;
+    bool job_delivering;            /* A worker is delivering completed jobs        */
+#endif
+
+#if AT_CMD_ERROR_EVENTS > 0
+    cy_thread_t error_thread;
+    cy_mutex_t error_mutex;
+    cy_semaphore_t error_sem;
+    at_cmd_error_event_t error_events[AT_CMD_ERROR_EVENTS];
+    uint32_t error_head;
+    uint32_t error_count;
+#endif
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    cy_mutex_t limit_mutex;
+    at_cmd_limit_state_t limit_states[AT_CMD_LIMIT_ENTRIES];
+    at_cmd_limit_entry_t limit_entries[AT_CMD_LIMIT_ENTRIES];
+#endif
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+    cy_mutex_t batch_mutex;
+    at_cmd_batch_t batches[AT_CMD_MAX_BATCHES];
+#endif
+
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+    cy_mutex_t retransmit_mutex;
+    at_cmd_retransmit_entry_t retransmit_cache[AT_CMD_RETRANSMIT_CACHE_ENTRIES];
+    at_cmd_retransmit_stats_t retransmit_stats;
+#endif
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    at_cmd_diag_counters_t diag;
+#endif
+
+#ifdef ENABLE_AT_CMD_COMPRESSION
+    bool compress_async;
+#endif
 } at_cmd_parser_t;
 
 /******************************************************
  *                 Global Variables
  ******************************************************/
 
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+extern at_cmd_def_t g_at_cmd_diag_table[AT_CMD_DIAG_NUM_CMDS];
+#endif
+
 /******************************************************
  *               Function Declarations
  ******************************************************/
 
+/** Format an unsigned integer as decimal digits.
+ *
+ * @param[out] buf   : Pointer to a buffer with room for at least 10 characters.
+ * @param[in]  value : Value to format.
+ *
+ * @return Number of characters written. The output is not nul terminated.
+ */
+
+uint32_t at_cmd_format_uint(char *buf, uint32_t value);
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+/** Run a diagnostic command in place of queueing it for the application.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] msg        : Message returned by a diagnostic command callback. Freed by the call.
+ */
+
+void at_cmd_diag_run(at_cmd_parser_t *cmd_parser, at_cmd_msg_base_t *msg);
+
+/** Reset the diagnostic counters.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ */
+
+void at_cmd_diag_reset(at_cmd_parser_t *cmd_parser);
+
+/** Read the diagnostic counters.
+ *
+ * @param[in]  cmd_parser : Pointer to the main parser structure
+ * @param[out] stats      : Counters since the last reset.
+ */
+
+void at_cmd_diag_read(at_cmd_parser_t *cmd_parser, at_cmd_diag_stats_t *stats);
+#endif
+
+#ifdef ENABLE_AT_CMD_COMPRESSION
+/** Compress a block of data.
+ *
+ * @param[in]  src        : Pointer to the data to compress.
+ * @param[in]  src_len    : Length of the data in bytes.
+ * @param[out] dst        : Pointer to the output buffer.
+ * @param[in]  dst_size   : Size of the output buffer in bytes.
+ * @param[in]  hash_table : Scratch table of (1 << AT_CMD_COMPRESS_HASH_BITS) entries.
+ *
+ * @return Number of compressed bytes or 0 if the data does not fit in dst_size bytes.
+ */
+
+uint32_t at_cmd_compress(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_size, uint16_t *hash_table);
+
+/** Decompress a block of data produced by at_cmd_compress().
+ *
+ * @param[in]  src      : Pointer to the compressed data.
+ * @param[in]  src_len  : Length of the compressed data in bytes.
+ * @param[out] dst      : Pointer to the output buffer.
+ * @param[in]  dst_size : Size of the output buffer in bytes.
+ *
+ * @return Number of decompressed bytes or 0 if the data is malformed or does not fit in dst_size bytes.
+ */
+
+uint32_t at_cmd_decompress(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_size);
+#endif
 
 #ifdef __cplusplus
 }
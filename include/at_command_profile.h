@@ -0,0 +1,144 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file at_command_profile.h
+ * @brief AT Command Parser Library build profiles
+ *
+ * A profile selects the features and buffer sizes of the library at compile time.
+ * Build with AT_CMD_PROFILE set to one of the profiles below. Any option that is
+ * defined on the compiler command line overrides the value chosen by the profile.
+ */
+
+#pragma once
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+/**
+ * \addtogroup group_at_cmd_parser_macros
+ * \{
+ */
+
+/** Smallest RAM and code size. 1000 byte commands, no optional features or logging. */
+#define AT_CMD_PROFILE_MINIMAL                      (1)
+
+/** The library defaults. 6000 byte commands, no optional features. */
+#define AT_CMD_PROFILE_STANDARD                     (2)
+
+/** All optional device side features with worker threads and logging. */
+#define AT_CMD_PROFILE_FULL                         (3)
+
+#ifndef AT_CMD_PROFILE
+/** Build profile of the library. */
+#define AT_CMD_PROFILE                              AT_CMD_PROFILE_STANDARD
+#endif
+
+/** \} group_at_cmd_parser_macros */
+
+#if AT_CMD_PROFILE == AT_CMD_PROFILE_MINIMAL
+
+/*
+ * The command and output buffers dominate the static RAM of the library.
+ */
+
+#ifndef AT_CMD_MAX_SIZE
+#define AT_CMD_MAX_SIZE                             (1000)
+#endif
+
+#ifndef AT_CMD_PARSER_BUFFER_SIZE
+#define AT_CMD_PARSER_BUFFER_SIZE                   (1024+40)
+#endif
+
+#ifndef INPUT_BUFFER_SIZE
+#define INPUT_BUFFER_SIZE                           (128U)
+#endif
+
+#ifndef INPUT_THREAD_STACK_SIZE
+#define INPUT_THREAD_STACK_SIZE                     (2*1024)
+#endif
+
+#ifndef AT_CMD_MAX_CMD_CLASSES
+#define AT_CMD_MAX_CMD_CLASSES                      (1)
+#endif
+
+#ifndef AT_CMD_MAX_INLINE_MSG_SIZE
+#define AT_CMD_MAX_INLINE_MSG_SIZE                  (0)
+#endif
+
+#elif AT_CMD_PROFILE == AT_CMD_PROFILE_FULL
+
+#ifndef ENABLE_AT_CMD_LOGS
+#define ENABLE_AT_CMD_LOGS
+#endif
+
+#ifndef ENABLE_AT_CMD_STREAMING
+#define ENABLE_AT_CMD_STREAMING
+#endif
+
+#ifndef ENABLE_AT_CMD_COMPRESSION
+#define ENABLE_AT_CMD_COMPRESSION
+#endif
+
+#ifndef ENABLE_AT_CMD_DIAGNOSTICS
+#define ENABLE_AT_CMD_DIAGNOSTICS
+#endif
+
+#ifndef AT_CMD_NUM_OUTPUT_BUFFERS
+#define AT_CMD_NUM_OUTPUT_BUFFERS                   (2)
+#endif
+
+#ifndef AT_CMD_NUM_WORKERS
+#define AT_CMD_NUM_WORKERS                          (2)
+#endif
+
+#ifndef AT_CMD_RETRANSMIT_CACHE_ENTRIES
+#define AT_CMD_RETRANSMIT_CACHE_ENTRIES             (8)
+#endif
+
+#ifndef AT_CMD_BATCH_MAX_ENTRIES
+#define AT_CMD_BATCH_MAX_ENTRIES                    (8)
+#endif
+
+#ifndef AT_CMD_ERROR_EVENTS
+#define AT_CMD_ERROR_EVENTS                         (8)
+#endif
+
+#ifndef AT_CMD_LIMIT_ENTRIES
+#define AT_CMD_LIMIT_ENTRIES                        (8)
+#endif
+
+#elif AT_CMD_PROFILE != AT_CMD_PROFILE_STANDARD
+#error "Unknown AT_CMD_PROFILE"
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+* @file at_command_compress.c
+* @brief Payload compression for asynchronous host messages.
+*
+* The encoding is a byte oriented LZ77 variant. The output is a sequence of tokens:
+*
+* - Control byte 0x00 - 0x7F: literal run. (control + 1) literal bytes follow.
+* - Control byte 0x80 - 0xFF: match. Copy ((control & 0x7F) + 3) bytes starting
+*   at offset bytes back in the output. The two byte big endian offset follows.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cy_result.h"
+#include "cyabs_rtos.h"
+
+#include "at_command_parser.h"
+#include "at_command_parser_private.h"
+
+#ifdef ENABLE_AT_CMD_COMPRESSION
+
+/******************************************************
+ *                      Macros
+ ******************************************************/
+
+#define AT_CMD_COMPRESS_HASH(p)         ((((uint32_t)(p)[0] << 16) ^ ((uint32_t)(p)[1] << 8) ^ (uint32_t)(p)[2]) * 2654435761U >> (32 - AT_CMD_COMPRESS_HASH_BITS))
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define AT_CMD_COMPRESS_MIN_MATCH       (3)
+#define AT_CMD_COMPRESS_MAX_MATCH       (0x7F + AT_CMD_COMPRESS_MIN_MATCH)
+#define AT_CMD_COMPRESS_MAX_LITERALS    (0x80)
+#define AT_CMD_COMPRESS_MATCH_FLAG      (0x80)
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Flush a pending literal run to the output.
+ *
+ * @param[in]    src      : Pointer to the first literal byte.
+ * @param[in]    count    : Number of literal bytes.
+ * @param[inout] dst      : Pointer to the output buffer.
+ * @param[inout] dst_idx  : Current output index.
+ * @param[in]    dst_size : Size of the output buffer.
+ *
+ * @return false if the output buffer is too small.
+ */
+
+static bool at_cmd_compress_literals(const uint8_t *src, uint32_t count, uint8_t *dst, uint32_t *dst_idx, uint32_t dst_size)
+{
+    uint32_t run;
+
+    while (count > 0)
+    {
+        run = (count > AT_CMD_COMPRESS_MAX_LITERALS) ? AT_CMD_COMPRESS_MAX_LITERALS : count;
+        if (*dst_idx + run + 1 > dst_size)
+        {
+            return false;
+        }
+
+        dst[(*dst_idx)++] = (uint8_t)(run - 1);
+        memcpy(&dst[*dst_idx], src, run);
+        *dst_idx += run;
+        src      += run;
+        count    -= run;
+    }
+
+    return true;
+}
+
+
+uint32_t at_cmd_compress(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_size, uint16_t *hash_table)
+{
+    uint32_t literal_start;
+    uint32_t dst_idx;
+    uint32_t match_len;
+    uint32_t offset;
+    uint32_t cand;
+    uint32_t hash;
+    uint32_t i;
+
+    if (src == NULL || dst == NULL || hash_table == NULL || src_len == 0 || src_len > UINT16_MAX)
+    {
+        return 0;
+    }
+
+    /*
+     * Position zero is a valid match candidate so mark empty slots with UINT16_MAX.
+     */
+
+    memset(hash_table, 0xFF, sizeof(uint16_t) * (1 << AT_CMD_COMPRESS_HASH_BITS));
+
+    literal_start = 0;
+    dst_idx       = 0;
+    i             = 0;
+
+    while (i + AT_CMD_COMPRESS_MIN_MATCH <= src_len)
+    {
+        hash             = AT_CMD_COMPRESS_HASH(&src[i]);
+        cand             = hash_table[hash];
+        hash_table[hash] = (uint16_t)i;
+
+        if (cand == UINT16_MAX || i - cand > AT_CMD_COMPRESS_WINDOW_SIZE ||
+            memcmp(&src[cand], &src[i], AT_CMD_COMPRESS_MIN_MATCH) != 0)
+        {
+            i++;
+            continue;
+        }
+
+        /*
+         * Extend the match as far as we can.
+         */
+
+        match_len = AT_CMD_COMPRESS_MIN_MATCH;
+        while (i + match_len < src_len && match_len < AT_CMD_COMPRESS_MAX_MATCH && src[cand + match_len] == src[i + match_len])
+        {
+            match_len++;
+        }
+
+        if (!at_cmd_compress_literals(&src[literal_start], i - literal_start, dst, &dst_idx, dst_size) || dst_idx + 3 > dst_size)
+        {
+            return 0;
+        }
+
+        offset = i - cand;
+        dst[dst_idx++] = (uint8_t)(AT_CMD_COMPRESS_MATCH_FLAG | (match_len - AT_CMD_COMPRESS_MIN_MATCH));
+        dst[dst_idx++] = (uint8_t)(offset >> 8);
+        dst[dst_idx++] = (uint8_t)(offset & 0xFF);
+
+        i += match_len;
+        literal_start = i;
+    }
+
+    if (!at_cmd_compress_literals(&src[literal_start], src_len - literal_start, dst, &dst_idx, dst_size))
+    {
+        return 0;
+    }
+
+    return dst_idx;
+}
+
+uint32_t at_cmd_decompress(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_size)
+{
+    uint32_t dst_idx;
+    uint32_t offset;
+    uint32_t count;
+    uint32_t i;
+
+    if (src == NULL || dst == NULL)
+    {
+        return 0;
+    }
+
+    dst_idx = 0;
+    i       = 0;
+
+    while (i < src_len)
+    {
+        if (src[i] & AT_CMD_COMPRESS_MATCH_FLAG)
+        {
+            if (i + 3 > src_len)
+            {
+                return 0;
+            }
+
+            count  = (uint32_t)(src[i] & ~AT_CMD_COMPRESS_MATCH_FLAG) + AT_CMD_COMPRESS_MIN_MATCH;
+            offset = ((uint32_t)src[i + 1] << 8) | src[i + 2];
+            i     += 3;
+
+            if (offset == 0 || offset > dst_idx || dst_idx + count > dst_size)
+            {
+                return 0;
+            }
+
+            /*
+             * The match may overlap the bytes being written so copy one byte at a time.
+             */
+
+            while (count-- > 0)
+            {
+                dst[dst_idx] = dst[dst_idx - offset];
+                dst_idx++;
+            }
+        }
+        else
+        {
+            count = (uint32_t)src[i++] + 1;
+            if (i + count > src_len || dst_idx + count > dst_size)
+            {
+                return 0;
+            }
+
+            memcpy(&dst[dst_idx], &src[i], count);
+            dst_idx += count;
+            i       += count;
+        }
+    }
+
+    return dst_idx;
+}
+
+#endif /* ENABLE_AT_CMD_COMPRESSION */
@@ -0,0 +1,421 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+* @file at_command_diag.c
+* @brief Diagnostic commands for measuring the throughput of the transport and parser.
+*
+* The diagnostic commands are run by the library in place of being queued for the
+* application. They use the same read_data and write_data transport functions as every
+* other command so a deployed unit can be measured end to end.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cy_result.h"
+#include "cyabs_rtos.h"
+
+#include "at_command_parser.h"
+#include "at_command_parser_private.h"
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define AT_CMD_DIAG_DATA_MSG_NAME       "DiagData"
+#define AT_CMD_DIAG_FILL_CHARS          (64)
+
+/******************************************************
+ *                    Structures
+ ******************************************************/
+
+typedef struct
+{
+    at_cmd_msg_base_t base;
+    uint32_t bytes;                 /* DiagSource payload bytes to send         */
+    uint32_t size;                  /* DiagSource payload bytes per message     */
+    bool reset;                     /* DiagStats resets the counters            */
+    uint32_t len;
+    char text[];                    /* DiagEcho response text                   */
+} at_cmd_diag_msg_t;
+
+/******************************************************
+ *               Static Function Declarations
+ ******************************************************/
+
+static at_cmd_msg_base_t *at_cmd_diag_cmd_parser(uint32_t cmd_id, uint32_t serial, uint32_t len, uint8_t *args);
+static at_cmd_msg_base_t *at_cmd_diag_binary_parser(uint32_t cmd_id, uint32_t serial, uint8_t *data, uint32_t data_len);
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+at_cmd_def_t g_at_cmd_diag_table[AT_CMD_DIAG_NUM_CMDS] =
+{
+    { .cmd_name = "DiagEcho",   .cmd_id = AT_CMD_DIAG_CMD_ID_ECHO,   .cmd_parser = at_cmd_diag_cmd_parser },
+    { .cmd_name = "DiagSink",   .cmd_id = AT_CMD_DIAG_CMD_ID_SINK,   .cmd_parser = at_cmd_diag_cmd_parser,
+      .binary_parser = at_cmd_diag_binary_parser },
+    { .cmd_name = "DiagSource", .cmd_id = AT_CMD_DIAG_CMD_ID_SOURCE, .cmd_parser = at_cmd_diag_cmd_parser },
+    { .cmd_name = "DiagStats",  .cmd_id = AT_CMD_DIAG_CMD_ID_STATS,  .cmd_parser = at_cmd_diag_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Find an unsigned integer member in JSON text.
+ *
+ * Only a flat object is expected so the first match of the quoted key is used.
+ *
+ * @param[in] text          : Nul terminated JSON text.
+ * @param[in] key           : Member name.
+ * @param[in] default_value : Value returned if the member is not found.
+ *
+ * @return Value of the member.
+ */
+
+static uint32_t at_cmd_diag_get_uint(const char *text, const char *key, uint32_t default_value)
+{
+    const char *ptr = text;
+    size_t key_len = strlen(key);
+    uint32_t value;
+
+    while ((ptr = strstr(ptr, key)) != NULL)
+    {
+        if (ptr > text && ptr[-1] == '"' && ptr[key_len] == '"')
+        {
+            break;
+        }
+        ptr += key_len;
+    }
+
+    if (ptr == NULL)
+    {
+        return default_value;
+    }
+
+    for (ptr += key_len + 1; *ptr == ' ' || *ptr == ':'; ptr++)
+    {
+    }
+
+    if (*ptr < '0' || *ptr > '9')
+    {
+        return default_value;
+    }
+
+    for (value = 0; *ptr >= '0' && *ptr <= '9'; ptr++)
+    {
+        value = value * 10 + (uint32_t)(*ptr - '0');
+    }
+
+    return value;
+}
+
+
+/** Calculate a rate per second.
+ *
+ * @param[in] count      : Number of events.
+ * @param[in] elapsed_ms : Time taken in milliseconds.
+ *
+ * @return Events per second.
+ */
+
+static uint32_t at_cmd_diag_rate(uint32_t count, uint32_t elapsed_ms)
+{
+    return (uint32_t)(((uint64_t)count * 1000) / ((elapsed_ms > 0) ? elapsed_ms : 1));
+}
+
+
+/** Command callback for the diagnostic commands.
+ *
+ * @param[in] cmd_id : Command id.
+ * @param[in] serial : Serial number of the command.
+ * @param[in] len    : Length of the command arguments.
+ * @param[in] args   : Command arguments.
+ *
+ * @return Message for at_cmd_diag_run().
+ */
+
+static at_cmd_msg_base_t *at_cmd_diag_cmd_parser(uint32_t cmd_id, uint32_t serial, uint32_t len, uint8_t *args)
+{
+    at_cmd_diag_msg_t *msg;
+    uint32_t text_len;
+
+    /*
+     * Only DiagEcho keeps the text. The other commands just need the values from it.
+     */
+
+    text_len = (cmd_id == AT_CMD_DIAG_CMD_ID_ECHO) ? len : 0;
+    msg = calloc(1, sizeof(at_cmd_diag_msg_t) + text_len + 1);
+    if (msg == NULL)
+    {
+        return NULL;
+    }
+
+    msg->base.cmd_id = cmd_id;
+    msg->base.serial = serial;
+    msg->len         = text_len;
+    memcpy(msg->text, args, text_len);
+
+    if (cmd_id == AT_CMD_DIAG_CMD_ID_SOURCE)
+    {
+        msg->bytes = at_cmd_diag_get_uint((char *)args, "bytes", 0);
+        msg->size  = at_cmd_diag_get_uint((char *)args, "size", AT_CMD_DIAG_DEFAULT_FRAME_SIZE);
+    }
+    else if (cmd_id == AT_CMD_DIAG_CMD_ID_STATS)
+    {
+        msg->reset = (strstr((char *)args, "\"reset\":true") != NULL);
+    }
+
+    return &msg->base;
+}
+
+
+/** Binary command callback for DiagSink.
+ *
+ * @param[in] cmd_id   : Command id.
+ * @param[in] serial   : Serial number of the command.
+ * @param[in] data     : Command data.
+ * @param[in] data_len : Length of the command data.
+ *
+ * @return Message for at_cmd_diag_run().
+ */
+
+static at_cmd_msg_base_t *at_cmd_diag_binary_parser(uint32_t cmd_id, uint32_t serial, uint8_t *data, uint32_t data_len)
+{
+    at_cmd_diag_msg_t *msg;
+
+    (void)data;
+    (void)data_len;
+
+    msg = calloc(1, sizeof(at_cmd_diag_msg_t) + 1);
+    if (msg == NULL)
+    {
+        return NULL;
+    }
+
+    msg->base.cmd_id = cmd_id;
+    msg->base.serial = serial;
+
+    return &msg->base;
+}
+
+
+/** Send DiagData messages as fast as the transport accepts them and report the rate.
+ *
+ * @param[in] serial : Serial number of the DiagSource command.
+ * @param[in] bytes  : Payload bytes to send.
+ * @param[in] size   : Payload bytes per message.
+ */
+
+static void at_cmd_diag_source(uint32_t serial, uint32_t bytes, uint32_t size)
+{
+    char fill[AT_CMD_DIAG_FILL_CHARS];
+    at_cmd_response_t rsp;
+    cy_time_t start;
+    cy_time_t end;
+    uint32_t frames;
+    uint32_t sent;
+    uint32_t frame_len;
+    uint32_t chunk;
+    uint32_t elapsed;
+    uint32_t i;
+
+    if (size == 0 || size > AT_CMD_DIAG_MAX_FRAME_SIZE)
+    {
+        at_cmd_parser_send_cmd_response(serial, AT_CMD_STATUS_ERROR, "Invalid size");
+        return;
+    }
+
+    /*
+     * The command runs on the thread that delivers commands, so bound how long it holds off other input.
+     */
+
+    if (bytes > AT_CMD_DIAG_MAX_SOURCE_BYTES)
+    {
+        at_cmd_parser_send_cmd_response(serial, AT_CMD_STATUS_ERROR, "Invalid bytes");
+        return;
+    }
+
+    memset(fill, 'x', sizeof(fill));
+    frames = 0;
+    sent   = 0;
+
+    cy_rtos_get_time(&start);
+    while (sent < bytes)
+    {
+        frame_len = (bytes - sent < size) ? bytes - sent : size;
+        if (at_cmd_parser_async_response_begin(&rsp, serial, AT_CMD_DIAG_DATA_MSG_NAME) != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+
+        at_cmd_parser_response_append(&rsp, "{\"d\":\"", 6);
+        for (i = 0; i < frame_len; i += chunk)
+        {
+            chunk = (frame_len - i < sizeof(fill)) ? frame_len - i : sizeof(fill);
+            at_cmd_parser_response_append(&rsp, fill, chunk);
+        }
+        at_cmd_parser_response_append(&rsp, "\"}", 2);
+
+        if (at_cmd_parser_response_send(&rsp) != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+
+        sent += frame_len;
+        frames++;
+    }
+    cy_rtos_get_time(&end);
+    elapsed = (uint32_t)(end - start);
+
+    if (at_cmd_parser_response_begin(&rsp, serial, (sent < bytes) ? AT_CMD_STATUS_ERROR : AT_CMD_STATUS_SUCCESS) != CY_RSLT_SUCCESS)
+    {
+        return;
+    }
+
+    at_cmd_parser_json_object_begin(&rsp, NULL);
+    at_cmd_parser_json_add_uint(&rsp, "bytes", sent);
+    at_cmd_parser_json_add_uint(&rsp, "frames", frames);
+    at_cmd_parser_json_add_uint(&rsp, "ms", elapsed);
+    at_cmd_parser_json_add_uint(&rsp, "bytes_per_sec", at_cmd_diag_rate(sent, elapsed));
+    at_cmd_parser_json_add_uint(&rsp, "frames_per_sec", at_cmd_diag_rate(frames, elapsed));
+    at_cmd_parser_json_object_end(&rsp);
+    at_cmd_parser_response_send(&rsp);
+}
+
+
+/** Report the diagnostic counters.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the DiagStats command.
+ * @param[in] reset      : Reset the counters after reading them.
+ */
+
+static void at_cmd_diag_stats(at_cmd_parser_t *cmd_parser, uint32_t serial, bool reset)
+{
+    at_cmd_diag_stats_t stats;
+    at_cmd_footprint_t footprint;
+    at_cmd_response_t rsp;
+
+    at_cmd_diag_read(cmd_parser, &stats);
+    at_cmd_parser_get_footprint(&footprint);
+    if (reset)
+    {
+        at_cmd_diag_reset(cmd_parser);
+    }
+
+    if (at_cmd_parser_response_begin(&rsp, serial, AT_CMD_STATUS_SUCCESS) != CY_RSLT_SUCCESS)
+    {
+        return;
+    }
+
+    at_cmd_parser_json_object_begin(&rsp, NULL);
+    at_cmd_parser_json_add_uint(&rsp, "rx_bytes", stats.rx_bytes);
+    at_cmd_parser_json_add_uint(&rsp, "rx_reads", stats.rx_reads);
+    at_cmd_parser_json_add_uint(&rsp, "rx_frames", stats.rx_frames);
+    at_cmd_parser_json_add_uint(&rsp, "tx_bytes", stats.tx_bytes);
+    at_cmd_parser_json_add_uint(&rsp, "tx_frames", stats.tx_frames);
+    at_cmd_parser_json_add_uint(&rsp, "ms", stats.elapsed_ms);
+    at_cmd_parser_json_add_uint(&rsp, "rx_bytes_per_sec", at_cmd_diag_rate(stats.rx_bytes, stats.elapsed_ms));
+    at_cmd_parser_json_add_uint(&rsp, "rx_frames_per_sec", at_cmd_diag_rate(stats.rx_frames, stats.elapsed_ms));
+    at_cmd_parser_json_add_uint(&rsp, "tx_bytes_per_sec", at_cmd_diag_rate(stats.tx_bytes, stats.elapsed_ms));
+    at_cmd_parser_json_add_uint(&rsp, "tx_frames_per_sec", at_cmd_diag_rate(stats.tx_frames, stats.elapsed_ms));
+    at_cmd_parser_json_add_uint(&rsp, "profile", footprint.profile);
+    at_cmd_parser_json_add_uint(&rsp, "static_ram", footprint.static_ram);
+    at_cmd_parser_json_add_uint(&rsp, "thread_stacks", footprint.thread_stacks);
+    at_cmd_parser_json_object_end(&rsp);
+    at_cmd_parser_response_send(&rsp);
+}
+
+
+void at_cmd_diag_run(at_cmd_parser_t *cmd_parser, at_cmd_msg_base_t *msg)
+{
+    at_cmd_diag_msg_t *diag_msg = (at_cmd_diag_msg_t *)msg;
+
+    switch (msg->cmd_id)
+    {
+        case AT_CMD_DIAG_CMD_ID_ECHO:
+            at_cmd_parser_send_cmd_response(msg->serial, AT_CMD_STATUS_SUCCESS, diag_msg->text);
+            break;
+
+        case AT_CMD_DIAG_CMD_ID_SINK:
+            at_cmd_parser_send_cmd_response(msg->serial, AT_CMD_STATUS_SUCCESS, "");
+            break;
+
+        case AT_CMD_DIAG_CMD_ID_SOURCE:
+            at_cmd_diag_source(msg->serial, diag_msg->bytes, diag_msg->size);
+            break;
+
+        case AT_CMD_DIAG_CMD_ID_STATS:
+            at_cmd_diag_stats(cmd_parser, msg->serial, diag_msg->reset);
+            break;
+
+        default:
+            at_cmd_parser_send_cmd_response(msg->serial, AT_CMD_STATUS_ERROR, "Invalid cmd");
+            break;
+    }
+
+    free(msg);
+}
+
+
+void at_cmd_diag_reset(at_cmd_parser_t *cmd_parser)
+{
+    atomic_store(&cmd_parser->diag.rx_bytes, 0);
+    atomic_store(&cmd_parser->diag.rx_reads, 0);
+    atomic_store(&cmd_parser->diag.rx_frames, 0);
+    atomic_store(&cmd_parser->diag.tx_bytes, 0);
+    atomic_store(&cmd_parser->diag.tx_frames, 0);
+    cy_rtos_get_time(&cmd_parser->diag.start);
+}
+
+
+void at_cmd_diag_read(at_cmd_parser_t *cmd_parser, at_cmd_diag_stats_t *stats)
+{
+    cy_time_t now;
+
+    cy_rtos_get_time(&now);
+
+    stats->rx_bytes   = atomic_load(&cmd_parser->diag.rx_bytes);
+    stats->rx_reads   = atomic_load(&cmd_parser->diag.rx_reads);
+    stats->rx_frames  = atomic_load(&cmd_parser->diag.rx_frames);
+    stats->tx_bytes   = atomic_load(&cmd_parser->diag.tx_bytes);
+    stats->tx_frames  = atomic_load(&cmd_parser->diag.tx_frames);
+    stats->elapsed_ms = (uint32_t)(now - cmd_parser->diag.start);
+}
+
+#endif /* ENABLE_AT_CMD_DIAGNOSTICS */
@@ -0,0 +1,569 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+* @file at_command_host.c
+* @brief Host side client for the AT Command Parser Library wire format.
+*
+* The client formats command frames, gives each command a serial number and matches the
+* status responses and asynchronous messages read back from the device to the commands.
+* Any number of commands up to AT_CMD_HOST_MAX_PENDING may be outstanding at one time.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cy_result.h"
+
+#include "at_command_parser.h"
+#include "at_command_parser_private.h"
+#include "at_command_host.h"
+
+#ifdef ENABLE_AT_CMD_HOST
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define AT_CMD_HOST_MSG_START_CHAR      '+'
+#define AT_CMD_HOST_FIELD_SEPARATOR     ','
+#define AT_CMD_HOST_MAX_SERIAL_DIGITS   (10)
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Find the pending entry for a serial number.
+ *
+ * @param[in] host   : Pointer to the client instance.
+ * @param[in] serial : Serial number. 0 finds a free entry.
+ *
+ * @return Pointer to the entry or NULL if not found.
+ */
+
+static at_cmd_host_pending_t *at_cmd_host_find_pending(at_cmd_host_t *host, uint32_t serial)
+{
+    uint32_t i;
+
+    for (i = 0; i < AT_CMD_HOST_MAX_PENDING; i++)
+    {
+        if (host->pending[i].serial == serial)
+        {
+            return &host->pending[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/** Free a pending entry.
+ *
+ * @param[in] host  : Pointer to the client instance.
+ * @param[in] entry : Pointer to the entry.
+ */
+
+static void at_cmd_host_free_pending(at_cmd_host_t *host, at_cmd_host_pending_t *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    host->num_pending--;
+}
+
+
+/** Allocate a serial number and pending entry for a new command.
+ *
+ * Serial number 0 is never used since the device uses it for messages not caused by a command.
+ *
+ * @param[in] host : Pointer to the client instance.
+ *
+ * @return Pointer to the entry or NULL if too many commands are pending.
+ */
+
+static at_cmd_host_pending_t *at_cmd_host_alloc_pending(at_cmd_host_t *host)
+{
+    at_cmd_host_pending_t *entry;
+    uint32_t serial;
+
+    if (host->num_pending >= AT_CMD_HOST_MAX_PENDING || (entry = at_cmd_host_find_pending(host, 0)) == NULL)
+    {
+        return NULL;
+    }
+
+    /*
+     * At most AT_CMD_HOST_MAX_PENDING serial numbers are in use so the search always ends.
+     */
+
+    do
+    {
+        serial = host->next_serial++;
+    } while (serial == 0 || at_cmd_host_find_pending(host, serial) != NULL);
+
+    memset(entry, 0, sizeof(*entry));
+    entry->serial = serial;
+    host->num_pending++;
+
+    return entry;
+}
+
+
+/** Format and write a command frame.
+ *
+ * @param[in]  host        : Pointer to the client instance.
+ * @param[in]  binary      : true to send a binary command frame.
+ * @param[in]  cmd_name    : Command name.
+ * @param[in]  data        : Command data, or NULL for none.
+ * @param[in]  data_len    : Length of the command data.
+ * @param[in]  response_cb : Status response callback.
+ * @param[in]  async_cb    : Asynchronous message callback.
+ * @param[in]  arg         : Callback argument.
+ * @param[out] serial      : Serial number of the command. May be NULL.
+ *
+ * @return Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_host_send_frame(at_cmd_host_t *host, bool binary, const char *cmd_name, const uint8_t *data, uint32_t data_len,
+                                        at_cmd_host_response_cb_t response_cb, at_cmd_host_async_cb_t async_cb, void *arg, uint32_t *serial)
+{
+    at_cmd_host_pending_t *entry;
+    cy_rslt_t result;
+    uint32_t name_len;
+    uint32_t size;
+    uint32_t len;
+    uint32_t i;
+    char *buf;
+
+    if (host == NULL || host->write == NULL || cmd_name == NULL || (data == NULL && data_len > 0))
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    name_len = strlen(cmd_name);
+    size     = name_len + (data_len > 0 ? data_len + 1 : 0);
+    if (name_len == 0 || size > AT_CMD_MAX_SIZE)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    if (AT_CMD_PREFIX_CHARS + 1 + AT_CMD_SIZE_CHARS + 2 * AT_CMD_HOST_MAX_SERIAL_DIGITS + 1 + size + 3 > AT_CMD_HOST_BUFFER_SIZE)
+    {
+        return CY_AT_CMD_PARSER_BUFFER_OVERFLOW;
+    }
+
+    if ((entry = at_cmd_host_alloc_pending(host)) == NULL)
+    {
+        return CY_AT_CMD_PARSER_NO_MEMORY;
+    }
+
+    entry->response_cb = response_cb;
+    entry->async_cb    = async_cb;
+    entry->arg         = arg;
+
+    /*
+     * AT+[B]XXXX#[@ms];Command_Name[,Data];
+     */
+
+    buf = host->tx_buffer;
+    memcpy(buf, AT_CMD_PREFIX, AT_CMD_PREFIX_CHARS);
+    len = AT_CMD_PREFIX_CHARS;
+    if (binary)
+    {
+        buf[len++] = AT_CMD_BINARY_MARKER_CHAR;
+    }
+
+    for (i = AT_CMD_SIZE_CHARS; i > 0; i--)
+    {
+        buf[len + i - 1] = (char)('0' + size % 10);
+        size /= 10;
+    }
+    len += AT_CMD_SIZE_CHARS;
+
+    len += at_cmd_format_uint(&buf[len], entry->serial);
+    if (host->timeout_ms > 0)
+    {
+        buf[len++] = AT_CMD_DEADLINE_CHAR;
+        len += at_cmd_format_uint(&buf[len], host->timeout_ms);
+    }
+    buf[len++] = AT_CMD_TERMINATOR_CHAR;
+    memcpy(&buf[len], cmd_name, name_len);
+    len += name_len;
+    if (data_len > 0)
+    {
+        buf[len++] = AT_CMD_HOST_FIELD_SEPARATOR;
+        memcpy(&buf[len], data, data_len);
+        len += data_len;
+    }
+    buf[len++] = AT_CMD_TERMINATOR_CHAR;
+    buf[len++] = '\n';
+
+    if (serial != NULL)
+    {
+        *serial = entry->serial;
+    }
+
+    result = host->write((const uint8_t *)buf, len, host->opaque);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cmd_host_free_pending(host, entry);
+    }
+
+    return result;
+}
+
+
+/** Deliver a status response.
+ *
+ * @param[in] host : Pointer to the client instance.
+ * @param[in] body : Nul terminated message body.
+ * @param[in] len  : Length of the message body.
+ */
+
+static void at_cmd_host_process_status(at_cmd_host_t *host, char *body, uint32_t len)
+{
+    at_cmd_host_pending_t *entry;
+    at_cmd_host_response_cb_t response_cb;
+    void *arg;
+    uint32_t status;
+    uint32_t i;
+
+    /*
+     * NN[,Text]
+     */
+
+    status = 0;
+    for (i = 0; i < len && body[i] >= '0' && body[i] <= '9'; i++)
+    {
+        status = status * 10 + (uint32_t)(body[i] - '0');
+    }
+
+    if (i == 0 || (i < len && body[i] != AT_CMD_HOST_FIELD_SEPARATOR))
+    {
+        host->rx_errors++;
+        return;
+    }
+
+    if (i < len)
+    {
+        i++;
+    }
+
+    entry = (host->rx_serial != 0) ? at_cmd_host_find_pending(host, host->rx_serial) : NULL;
+    if (entry == NULL || entry->responded)
+    {
+        if (host->unmatched_cb != NULL)
+        {
+            host->unmatched_cb(host->rx_serial, status, &body[i], len - i, host->arg);
+        }
+        return;
+    }
+
+    /*
+     * Finish with the entry before the callback in case the callback sends another command.
+     */
+
+    response_cb = entry->response_cb;
+    arg         = entry->arg;
+    if (entry->async_cb != NULL)
+    {
+        entry->responded = true;
+    }
+    else
+    {
+        at_cmd_host_free_pending(host, entry);
+    }
+
+    if (response_cb != NULL)
+    {
+        response_cb(host->rx_serial, status, &body[i], len - i, arg);
+    }
+}
+
+
+/** Deliver an asynchronous message.
+ *
+ * @param[in] host : Pointer to the client instance.
+ * @param[in] body : Nul terminated message body.
+ * @param[in] len  : Length of the message body.
+ */
+
+static void at_cmd_host_process_async(at_cmd_host_t *host, char *body, uint32_t len)
+{
+    at_cmd_host_pending_t *entry;
+    char *text;
+
+    /*
+     * Message_Name,JSON_Text
+     */
+
+    text = memchr(body, AT_CMD_HOST_FIELD_SEPARATOR, len);
+    if (text != NULL)
+    {
+        *text++ = '\0';
+    }
+    else
+    {
+        text = &body[len];
+    }
+
+    entry = (host->rx_serial != 0) ? at_cmd_host_find_pending(host, host->rx_serial) : NULL;
+    if (entry != NULL && entry->async_cb != NULL)
+    {
+        entry->async_cb(host->rx_serial, body, text, len - (uint32_t)(text - body), entry->arg);
+    }
+    else if (host->async_cb != NULL)
+    {
+        host->async_cb(host->rx_serial, body, text, len - (uint32_t)(text - body), host->arg);
+    }
+}
+
+
+/** Process a complete message.
+ *
+ * @param[in] host : Pointer to the client instance.
+ */
+
+static void at_cmd_host_process_message(at_cmd_host_t *host)
+{
+    host->rx_buffer[host->rx_len] = '\0';
+
+    switch (host->rx_type)
+    {
+        case AT_CMD_STATUS_MSG_TYPE:
+            at_cmd_host_process_status(host, host->rx_buffer, host->rx_len);
+            break;
+
+        case AT_CMD_ASYNC_MSG_TYPE:
+            at_cmd_host_process_async(host, host->rx_buffer, host->rx_len);
+            break;
+
+#ifdef ENABLE_AT_CMD_COMPRESSION
+        case AT_CMD_COMPRESSED_MSG_TYPE:
+        {
+            uint32_t len;
+
+            len = at_cmd_decompress((uint8_t *)host->rx_buffer, host->rx_len, (uint8_t *)host->z_buffer, AT_CMD_HOST_BUFFER_SIZE);
+            if (len == 0)
+            {
+                host->rx_errors++;
+                break;
+            }
+            host->z_buffer[len] = '\0';
+            at_cmd_host_process_async(host, host->z_buffer, len);
+            break;
+        }
+#endif
+
+        default:
+            host->rx_errors++;
+            break;
+    }
+}
+
+
+cy_rslt_t at_cmd_host_init(at_cmd_host_t *host, at_cmd_host_write_t write, void *opaque,
+                           at_cmd_host_async_cb_t async_cb, at_cmd_host_response_cb_t unmatched_cb, void *arg)
+{
+    if (host == NULL || write == NULL)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    memset(host, 0, sizeof(*host));
+    host->write        = write;
+    host->opaque       = opaque;
+    host->async_cb     = async_cb;
+    host->unmatched_cb = unmatched_cb;
+    host->arg          = arg;
+    host->next_serial  = 1;
+    host->rx_state     = AT_CMD_HOST_RX_SCAN;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+cy_rslt_t at_cmd_host_send(at_cmd_host_t *host, const char *cmd_name, const char *args, uint32_t args_len,
+                           at_cmd_host_response_cb_t response_cb, at_cmd_host_async_cb_t async_cb, void *arg, uint32_t *serial)
+{
+    return at_cmd_host_send_frame(host, false, cmd_name, (const uint8_t *)args, args_len, response_cb, async_cb, arg, serial);
+}
+
+
+cy_rslt_t at_cmd_host_send_binary(at_cmd_host_t *host, const char *cmd_name, const uint8_t *data, uint32_t data_len,
+                                  at_cmd_host_response_cb_t response_cb, at_cmd_host_async_cb_t async_cb, void *arg, uint32_t *serial)
+{
+    return at_cmd_host_send_frame(host, true, cmd_name, data, data_len, response_cb, async_cb, arg, serial);
+}
+
+
+void at_cmd_host_set_timeout(at_cmd_host_t *host, uint32_t timeout_ms)
+{
+    if (host != NULL)
+    {
+        host->timeout_ms = timeout_ms;
+    }
+}
+
+
+void at_cmd_host_input(at_cmd_host_t *host, const uint8_t *data, uint32_t len)
+{
+    uint32_t count;
+    uint32_t i;
+    char c;
+
+    if (host == NULL || data == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        c = (char)data[i];
+        switch (host->rx_state)
+        {
+            case AT_CMD_HOST_RX_SCAN:
+                if (c == AT_CMD_HOST_MSG_START_CHAR)
+                {
+                    host->rx_state = AT_CMD_HOST_RX_TYPE;
+                }
+                break;
+
+            case AT_CMD_HOST_RX_TYPE:
+                if (c == AT_CMD_STATUS_MSG_TYPE || c == AT_CMD_ASYNC_MSG_TYPE || c == AT_CMD_COMPRESSED_MSG_TYPE)
+                {
+                    host->rx_type   = c;
+                    host->rx_size   = 0;
+                    host->rx_digits = 0;
+                    host->rx_state  = AT_CMD_HOST_RX_SIZE;
+                }
+                else if (c != AT_CMD_HOST_MSG_START_CHAR)
+                {
+                    /*
+                     * Not a message, for example the echo of an AT+ command.
+                     */
+
+                    host->rx_state = AT_CMD_HOST_RX_SCAN;
+                }
+                break;
+
+            case AT_CMD_HOST_RX_SIZE:
+                if (host->rx_digits < AT_CMD_SIZE_CHARS && c >= '0' && c <= '9')
+                {
+                    host->rx_size = host->rx_size * 10 + (uint32_t)(c - '0');
+                    host->rx_digits++;
+                }
+                else if (host->rx_digits == AT_CMD_SIZE_CHARS && c == AT_CMD_HOST_FIELD_SEPARATOR && host->rx_size <= AT_CMD_HOST_BUFFER_SIZE)
+                {
+                    host->rx_serial = 0;
+                    host->rx_digits = 0;
+                    host->rx_state  = AT_CMD_HOST_RX_SERIAL;
+                }
+                else
+                {
+                    host->rx_errors++;
+                    host->rx_state = AT_CMD_HOST_RX_SCAN;
+                }
+                break;
+
+            case AT_CMD_HOST_RX_SERIAL:
+                if (host->rx_digits < AT_CMD_HOST_MAX_SERIAL_DIGITS && c >= '0' && c <= '9')
+                {
+                    host->rx_serial = host->rx_serial * 10 + (uint32_t)(c - '0');
+                    host->rx_digits++;
+                }
+                else if (host->rx_digits > 0 && c == AT_CMD_TERMINATOR_CHAR)
+                {
+                    host->rx_len   = 0;
+                    host->rx_state = (host->rx_size > 0) ? AT_CMD_HOST_RX_BODY : AT_CMD_HOST_RX_TRAILER;
+                }
+                else
+                {
+                    host->rx_errors++;
+                    host->rx_state = AT_CMD_HOST_RX_SCAN;
+                }
+                break;
+
+            case AT_CMD_HOST_RX_BODY:
+                /*
+                 * The body is counted, not scanned, so copy as much of it as is available.
+                 */
+
+                count = host->rx_size - host->rx_len;
+                if (count > len - i)
+                {
+                    count = len - i;
+                }
+                memcpy(&host->rx_buffer[host->rx_len], &data[i], count);
+                host->rx_len += count;
+                i            += count - 1;
+                if (host->rx_len == host->rx_size)
+                {
+                    host->rx_state = AT_CMD_HOST_RX_TRAILER;
+                }
+                break;
+
+            case AT_CMD_HOST_RX_TRAILER:
+                host->rx_state = AT_CMD_HOST_RX_SCAN;
+                if (c == AT_CMD_TERMINATOR_CHAR)
+                {
+                    at_cmd_host_process_message(host);
+                }
+                else
+                {
+                    host->rx_errors++;
+                }
+                break;
+        }
+    }
+}
+
+
+cy_rslt_t at_cmd_host_release(at_cmd_host_t *host, uint32_t serial)
+{
+    at_cmd_host_pending_t *entry;
+
+    if (host == NULL || serial == 0 || (entry = at_cmd_host_find_pending(host, serial)) == NULL)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    at_cmd_host_free_pending(host, entry);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+uint32_t at_cmd_host_pending(at_cmd_host_t *host)
+{
+    return (host != NULL) ? host->num_pending : 0;
+}
+
+#endif /* ENABLE_AT_CMD_HOST */
@@ -38,6 +38,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 #include <ctype.h>
 
@@ -63,12 +64,24 @@
  ******************************************************/
 
 #ifndef INPUT_BUFFER_SIZE
-#define INPUT_BUFFER_SIZE           (64U)
+#define INPUT_BUFFER_SIZE           (512U)          /* Largest read requested from the transport    */
 #endif
 
+#ifndef INPUT_READ_SIZE_MIN
+#define INPUT_READ_SIZE_MIN         (64U)           /* Smallest read requested from the transport   */
+#endif
+
+#ifndef INPUT_DRAIN_LIMIT
+#define INPUT_DRAIN_LIMIT           (16U * 1024U)   /* Bytes read before yielding to other threads  */
+#endif
+
+#ifndef INPUT_THREAD_STACK_SIZE
 #define INPUT_THREAD_STACK_SIZE     (6*1024)
+#endif
 
+#ifndef AT_CMD_MSG_QUEUE_TIMEOUT
 #define AT_CMD_MSG_QUEUE_TIMEOUT    (200)
+#endif
 
 /******************************************************
  *                   Enumerations
@@ -86,6 +99,10 @@
  *               Static Function Declarations
  ******************************************************/
 
+static cy_rslt_t at_cmd_add_command_chars(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, uint8_t *chars, uint32_t count);
+static void at_cmd_response_abort(at_cmd_response_t *rsp);
+static cy_rslt_t at_cmd_send_status(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t status, char *text);
+
 /******************************************************
  *               Variable Definitions
  ******************************************************/
@@ -96,717 +113,3914 @@ static at_cmd_parser_t g_cmd_parser;
  *               Function Definitions
  ******************************************************/
 
-static void at_cmd_reset_command_buffer(at_cmd_parser_t *cmd_parser)
+static void at_cmd_reset_command_buffer(at_cmd_framer_t *framer)
 {
-    cmd_parser->reading_cmd       = false;
-    cmd_parser->cmd_header        = false;
-    cmd_parser->cmd_widx          = 0;
-    cmd_parser->cmd_size          = 0;
-    cmd_parser->at_cmd_prefix_idx = 0;
+    framer->reading_cmd       = false;
+    framer->cmd_header        = false;
+    framer->cmd_widx          = 0;
+    framer->cmd_size          = 0;
+    framer->at_cmd_prefix_idx = 0;
+    framer->size_end          = AT_CMD_PREFIX_CHARS + AT_CMD_SIZE_CHARS;
+    framer->binary            = false;
+    framer->deadline          = false;
+#ifdef ENABLE_AT_CMD_STREAMING
+    framer->streaming         = false;
+#endif
 }
 
 
-at_cmd_msg_base_t *at_cmd_parse_cmd(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t cmd_len, uint8_t *cmd_buf)
-{
-    at_cmd_msg_base_t *msg;
-    at_cmd_table_t *table;
-    at_cmd_def_t *cmd;
-    uint8_t *ptr;
-    uint32_t i;
-    int len;
-
-    if (cmd_buf == NULL)
-    {
-        return NULL;
-    }
-
-    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: parsing command: %s\n", (char *)cmd_buf);
+/** Wait until a rate limited output class has bandwidth available.
+ *
+ * @param[in] cmd_parser   : Pointer to the main parser structure
+ * @param[in] output_class : Output class of the message about to be sent.
+ */
 
-    /*
-     * Scan until we find a comma or a nul.
-     */
+static void at_cmd_output_throttle(at_cmd_parser_t *cmd_parser, at_cmd_output_class_t output_class)
+{
+    at_cmd_output_rate_t *rate = &cmd_parser->output_rate[output_class];
+    cy_time_t now;
+    uint32_t delay_ms;
+    int64_t tokens;
+    int32_t burst;
 
-    for (ptr = cmd_buf; *ptr != '\0'; ptr++)
+    while (1)
     {
-        if (*ptr == ',')
+        if (cy_rtos_mutex_get(&cmd_parser->output_mutex, CY_RTOS_NEVER_TIMEOUT) != CY_RSLT_SUCCESS)
         {
-            *ptr++ = '\0';
-            break;
+            return;
         }
-    }
-
-    /*
-     * Time to find a command match.
-     */
 
-    len = strlen((char *)cmd_buf);
-    for (table = cmd_parser->cmd_tables, cmd = NULL; table != NULL && cmd == NULL; table = table->next)
-    {
-        for (i = 0; i < table->num_cmds; i++)
+        if (rate->bytes_per_sec == 0)
         {
-            if (table->cmd_table[i].cmd_name != NULL && strlen(table->cmd_table[i].cmd_name) == len && !strncmp((char *)cmd_buf, table->cmd_table[i].cmd_name, len))
-            {
-                cmd = &table->cmd_table[i];
-                break;
-            }
+            cy_rtos_mutex_set(&cmd_parser->output_mutex);
+            return;
         }
-    }
 
-    if (cmd == NULL)
-    {
         /*
-         * Didn't find a matching command.
+         * Credit the class for the time that has passed since the last refill.
+         * Don't advance the refill time until at least one byte has been earned
+         * so that slow rates don't lose their fractional credit.
          */
 
-        return NULL;
-    }
+        cy_rtos_get_time(&now);
+        tokens = ((int64_t)(uint32_t)(now - rate->last_refill) * rate->bytes_per_sec) / 1000;
+        if (tokens > 0)
+        {
+            burst             = (int32_t)(((uint64_t)rate->bytes_per_sec * AT_CMD_OUTPUT_BURST_MS) / 1000);
+            tokens           += rate->tokens;
+            rate->tokens      = (tokens > burst) ? burst : (int32_t)tokens;
+            rate->last_refill = now;
+        }
 
-    /*
-     * Invoke the command callback.
-     */
+        if (rate->tokens >= 0)
+        {
+            cy_rtos_mutex_set(&cmd_parser->output_mutex);
+            return;
+        }
 
-    msg = cmd->cmd_parser(cmd->cmd_id, serial, cmd_len - ((uint32_t)ptr - (uint32_t)cmd_buf), ptr);
+        delay_ms = (uint32_t)(((uint64_t)(-rate->tokens) * 1000) / rate->bytes_per_sec) + 1;
+        cy_rtos_mutex_set(&cmd_parser->output_mutex);
 
-    return msg;
+        cy_rtos_delay_milliseconds(delay_ms);
+    }
 }
 
 
-/** Process a command buffer.
+/** Acquire an output buffer.
  *
- * @param[in] cmd_parser : Pointer to the main parser structure
- * @param[in] buffer     : Pointer to the command message buffer.
- * @param[in] count      : Number of bytes of data in message buffer.
+ * If no output buffer is free the caller waits. When a buffer is released it is handed
+ * to the waiter with the highest priority output class.
+ *
+ * @param[in]  cmd_parser   : Pointer to the main parser structure
+ * @param[in]  output_class : Output class of the message about to be sent.
+ * @param[out] index        : Index of the output buffer.
  *
  * @return    Status of the operation.
  */
 
-static cy_rslt_t at_cmd_process_command_buffer(at_cmd_parser_t *cmd_parser, uint8_t *buffer, uint32_t count)
+static cy_rslt_t at_cmd_output_acquire(at_cmd_parser_t *cmd_parser, at_cmd_output_class_t output_class, uint32_t *index)
 {
-    at_cmd_msg_queue_t msg_queue_entry;
-    at_cmd_msg_base_t *msg;
     cy_rslt_t result;
-    char *ptr;
-    char *end;
-    uint32_t serial;
-    uint32_t size;
-    int i;
+    uint32_t i;
 
-    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: incoming command: %s\n", (char *)buffer);
+    at_cmd_output_throttle(cmd_parser, output_class);
 
-    if (cmd_parser->echo_cmd)
+    result = cy_rtos_mutex_get(&cmd_parser->output_mutex, CY_RTOS_NEVER_TIMEOUT);
+    if (result != CY_RSLT_SUCCESS)
     {
-        /*
-         * Echo the AT command.
-         */
+        return result;
+    }
 
-        cmd_parser->write_data(buffer, count, cmd_parser->opaque);
-        cmd_parser->write_data((uint8_t *)"\n\r", 2, cmd_parser->opaque);
+    if (cmd_parser->output_free > 0)
+    {
+        cmd_parser->output_free--;
     }
+    else
+    {
+        /*
+         * All the buffers are in use. Wait for one to be handed over to us.
+         */
 
-    /*
-     * Make sure we have a valid message header.
-     */
+        cmd_parser->output_waiting[output_class]++;
+        cy_rtos_mutex_set(&cmd_parser->output_mutex);
 
-    if (count < AT_CMD_MIN_HEADER_SIZE || strncmp((const char *)buffer, cmd_parser->at_cmd_prefix, AT_CMD_PREFIX_CHARS))
-    {
-        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid msg header: %.*s\n", AT_CMD_MIN_HEADER_SIZE, (char *)buffer);
-        at_cmd_parser_send_cmd_response(0, 1, "Invalid command");
-        return CY_AT_CMD_PARSER_ERROR;
+        result = cy_rtos_semaphore_get(&cmd_parser->output_sem[output_class], CY_RTOS_NEVER_TIMEOUT);
+        if (result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        cy_rtos_mutex_get(&cmd_parser->output_mutex, CY_RTOS_NEVER_TIMEOUT);
     }
 
     /*
-     * Extract the data size.
+     * A buffer has been set aside for us, find it.
      */
 
-    for (size = 0, i = 0; i < AT_CMD_SIZE_CHARS; i++)
+    for (i = 0; i < cmd_parser->output_count; i++)
     {
-        if (!isdigit(buffer[AT_CMD_PREFIX_CHARS + i]))
+        if (cmd_parser->output[i].state == AT_CMD_OUTPUT_FREE)
         {
-            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid size digit %c\n", buffer[AT_CMD_PREFIX_CHARS + i]);
-            at_cmd_parser_send_cmd_response(0, 1, "Invalid size digit");
-            return CY_AT_CMD_PARSER_ERROR;
+            break;
         }
-        size = (size * 10) + buffer[AT_CMD_PREFIX_CHARS + i] - '0';
     }
 
-    if (size > AT_CMD_MAX_SIZE)
-    {
-        at_cmd_parser_send_cmd_response(0, 1, "Invalid size");
-        return CY_AT_CMD_PARSER_ERROR;
-    }
+    cmd_parser->output[i].state        = AT_CMD_OUTPUT_BUILDING;
+    cmd_parser->output[i].output_class = output_class;
+    *index = i;
 
-    /*
-     * There must be a serial number specified.
-     */
+    cy_rtos_mutex_set(&cmd_parser->output_mutex);
 
-    ptr = (char *)&buffer[AT_CMD_PREFIX_CHARS + AT_CMD_SIZE_CHARS];
-    serial = 0;
-    while (isdigit((int)*ptr))
-    {
-        serial = (serial * 10) + (*ptr++) - '0';
-    }
+    return CY_RSLT_SUCCESS;
+}
 
-    if (*ptr != AT_CMD_TERMINATOR_CHAR)
-    {
-        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid msg separator: %c\n", *ptr);
-        at_cmd_parser_send_cmd_response(0, 1, "Invalid format");
-        return CY_AT_CMD_PARSER_ERROR;
-    }
-    ptr++;
 
-    /*
-     * Strip off the trailing ;
-     */
+/** Release an output buffer.
+ *
+ * Must be called with the output mutex held.
+ *
+ * @param[in] cmd_parser   : Pointer to the main parser structure
+ * @param[in] index        : Index of the output buffer.
+ * @param[in] bytes_sent   : Number of bytes written to the transport.
+ */
 
-    end = (char *)((uint32_t)buffer + count - 1);
-    if (*end == AT_CMD_TERMINATOR_CHAR)
+static void at_cmd_output_release(at_cmd_parser_t *cmd_parser, uint32_t index, uint32_t bytes_sent)
+{
+    at_cmd_output_class_t output_class = cmd_parser->output[index].output_class;
+    int i;
+
+    if (cmd_parser->output_rate[output_class].bytes_per_sec != 0)
     {
-        *end = 0;
-        count--;
+        cmd_parser->output_rate[output_class].tokens -= (int32_t)bytes_sent;
     }
 
-    /*
-     * Send the command to the command parser.
-     */
+    cmd_parser->output[index].state = AT_CMD_OUTPUT_FREE;
 
-    msg = at_cmd_parse_cmd(cmd_parser, serial, count - ((uint32_t)ptr - (uint32_t)buffer), (uint8_t *)ptr);
-    if (msg == NULL)
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    if (bytes_sent > 0)
     {
-        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid cmd\n");
-        at_cmd_parser_send_cmd_response(0, 1, "Invalid cmd");
-        return CY_AT_CMD_PARSER_ERROR;
+        atomic_fetch_add_explicit(&cmd_parser->diag.tx_bytes, bytes_sent, memory_order_relaxed);
+        atomic_fetch_add_explicit(&cmd_parser->diag.tx_frames, 1, memory_order_relaxed);
     }
+#endif
 
     /*
-     * And send it off.
+     * Hand the buffer directly to the highest priority waiter.
      */
 
-    memset(&msg_queue_entry, 0, sizeof(msg_queue_entry));
-    msg_queue_entry.msg = msg;
-
-    if ((result = cy_rtos_queue_put(cmd_parser->msg_queue, &msg_queue_entry, AT_CMD_MSG_QUEUE_TIMEOUT)) != CY_RSLT_SUCCESS)
+    for (i = 0; i < AT_CMD_OUTPUT_CLASS_MAX; i++)
     {
-        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: error sending msg\n");
-        at_cmd_parser_send_cmd_response(0, 1, "queue error");
-        free(msg);
+        if (cmd_parser->output_waiting[i] > 0)
+        {
+            cmd_parser->output_waiting[i]--;
+            cy_rtos_semaphore_set(&cmd_parser->output_sem[i]);
+            return;
+        }
     }
 
-    return result;
+    cmd_parser->output_free++;
 }
 
 
-static uint32_t at_cmd_scan_cmd_header(at_cmd_parser_t *cmd_parser, uint8_t *chars, uint32_t count)
+/** Start an asynchronous write of the next queued frame.
+ *
+ * Frames are sent in output class priority order, oldest first within a class.
+ * Must be called with the output mutex held.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ */
+
+static void at_cmd_output_start_next(at_cmd_parser_t *cmd_parser)
 {
+    at_cmd_output_buffer_t *output;
+    at_cmd_output_buffer_t *next;
+    cy_rslt_t result;
     uint32_t i;
 
-    for (i = 0; i < count; i++)
+    while (!cmd_parser->output_sending)
     {
-
-        /*
-         * Are we extracting the command length field?
-         */
-
-        if (cmd_parser->cmd_widx < (AT_CMD_PREFIX_CHARS + AT_CMD_SIZE_CHARS))
+        for (i = 0, next = NULL; i < cmd_parser->output_count; i++)
         {
-            if (!isdigit(chars[i]))
+            output = &cmd_parser->output[i];
+            if (output->state == AT_CMD_OUTPUT_QUEUED &&
+                (next == NULL || output->output_class < next->output_class ||
+                 (output->output_class == next->output_class && (int32_t)(output->seq - next->seq) < 0)))
             {
-                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid size digit %c\n", chars[i]);
-                at_cmd_parser_send_cmd_response(0, 1, "Invalid size digit");
-                at_cmd_reset_command_buffer(cmd_parser);
-
-                return count;
+                next = output;
             }
-            cmd_parser->cmd_size = (cmd_parser->cmd_size * 10) + chars[i] - '0';
-            cmd_parser->command_buffer[cmd_parser->cmd_widx++] = chars[i];
-            continue;
         }
 
-        if (cmd_parser->cmd_widx >= (AT_CMD_PREFIX_CHARS + AT_CMD_SIZE_CHARS))
+        if (next == NULL)
         {
-            /*
-             * We need at least one digit for the serial number.
-             * After that it's just digits until we hit the ';' character.
-             */
-
-            if ((cmd_parser->cmd_widx == (AT_CMD_PREFIX_CHARS + AT_CMD_SIZE_CHARS)) && !isdigit(chars[i]))
-            {
-                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid serial number digit %c\n", chars[i]);
-                at_cmd_parser_send_cmd_response(0, 1, "Invalid serial digit");
-                at_cmd_reset_command_buffer(cmd_parser);
-
-                return count;
-            }
-            else if (!isdigit(chars[i]) && chars[i] != AT_CMD_TERMINATOR_CHAR)
-            {
-                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid format %c\n", chars[i]);
-                at_cmd_parser_send_cmd_response(0, 1, "Invalid format");
-                at_cmd_reset_command_buffer(cmd_parser);
-
-                return count;
-            }
-
-            if (chars[i] == AT_CMD_TERMINATOR_CHAR)
-            {
-                cmd_parser->command_buffer[cmd_parser->cmd_widx++] = chars[i];
-                cmd_parser->cmd_header = false;
-                if (cmd_parser->cmd_size > 0)
-                {
-                    /*
-                     * The specified command size is the number of characters between the ';'
-                     * characters. Add in what we've buffered so far and the trailing
-                     * ';' to the total size.
-                     */
-
-                    cmd_parser->cmd_size += cmd_parser->cmd_widx + 1;
-                    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: Total cmd size %lu\n", cmd_parser->cmd_size);
+            return;
+        }
 
-                    /*
-                     * Make sure the command size isn't too large for the input buffer.
-                     */
+        next->state = AT_CMD_OUTPUT_SENDING;
+        cmd_parser->output_sending = true;
 
-                    if (cmd_parser->cmd_size > AT_CMD_PARSER_BUFFER_SIZE)
-                    {
-                        at_cmd_parser_send_cmd_response(0, 1, "Input buffer size exceeded");
-                        at_cmd_reset_command_buffer(cmd_parser);
+        result = cmd_parser->write_data_async(next->buffer, next->len, cmd_parser->opaque);
+        if (result != CY_RSLT_SUCCESS && next->state == AT_CMD_OUTPUT_SENDING)
+        {
+            /*
+             * The write was never started so there won't be a completion.
+             */
 
-                        return count;
-                    }
-                }
-                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: Header complete\n");
-                break;
-            }
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error starting output write\n");
+            cmd_parser->output_sending = false;
+            at_cmd_output_release(cmd_parser, (uint32_t)(next - cmd_parser->output), 0);
         }
-        cmd_parser->command_buffer[cmd_parser->cmd_widx++] = chars[i];
     }
-
-    return i;
 }
 
 
-static uint32_t at_cmd_scan_for_prefix(at_cmd_parser_t *cmd_parser, uint8_t *chars, uint32_t count)
+/** Send the frame in an output buffer and release the buffer once it has been written.
+ *
+ * With an asynchronous transport the frame is queued and this returns without
+ * waiting for the write.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] index      : Index of the output buffer.
+ * @param[in] len        : Length of the frame.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_output_send(at_cmd_parser_t *cmd_parser, uint32_t index, uint32_t len)
 {
-    uint32_t i;
+    at_cmd_output_buffer_t *output = &cmd_parser->output[index];
+    cy_rslt_t result = CY_RSLT_SUCCESS;
 
-    for (i = 0; i < count; i++)
+    if (cmd_parser->write_data_async == NULL)
     {
-        if (chars[i] == cmd_parser->at_cmd_prefix[cmd_parser->at_cmd_prefix_idx])
-        {
-            cmd_parser->command_buffer[cmd_parser->cmd_widx++] = chars[i];
-            if (++cmd_parser->at_cmd_prefix_idx == AT_CMD_PREFIX_CHARS)
-            {
-                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: Command start detected\n");
-                cmd_parser->at_cmd_prefix_idx = 0;
-                cmd_parser->reading_cmd       = true;
-                cmd_parser->cmd_header        = true;
-                i++;
-                break;
-            }
-        }
-        else
-        {
-            if ((cmd_parser->at_cmd_prefix_idx > 0) && (chars[i] == cmd_parser->at_cmd_prefix[0]))
-            {
-                /*
-                 * Special case. We were processing a command start sequence and received a bad character.
-                 * But the character matches the start of a possible command start sequence. We need to
-                 * save it rather than throwing it away.
-                 */
+        result = cmd_parser->write_data(output->buffer, len, cmd_parser->opaque);
 
-                cmd_parser->command_buffer[0] = chars[i];
-                cmd_parser->at_cmd_prefix_idx = 1;
-                cmd_parser->cmd_widx          = 1;
-            }
-            else
-            {
-                cmd_parser->at_cmd_prefix_idx = 0;
-                cmd_parser->cmd_widx          = 0;
-            }
-        }
+        cy_rtos_mutex_get(&cmd_parser->output_mutex, CY_RTOS_NEVER_TIMEOUT);
+        at_cmd_output_release(cmd_parser, index, len);
+        cy_rtos_mutex_set(&cmd_parser->output_mutex);
+
+        return result;
     }
 
-    return i;
+    cy_rtos_mutex_get(&cmd_parser->output_mutex, CY_RTOS_NEVER_TIMEOUT);
+    output->len   = len;
+    output->seq   = cmd_parser->output_seq++;
+    output->state = AT_CMD_OUTPUT_QUEUED;
+    at_cmd_output_start_next(cmd_parser);
+    cy_rtos_mutex_set(&cmd_parser->output_mutex);
+
+    return result;
 }
 
 
-/** Add characters to the incoming command buffer.
+/** Release an output buffer without sending anything.
  *
  * @param[in] cmd_parser : Pointer to the main parser structure
- * @param[in] chars      : Pointer to the characters to add.
- * @param[in] count      : Number of characters to add.
- *
- * @return    Status of the operation.
+ * @param[in] index      : Index of the output buffer.
  */
 
-static cy_rslt_t at_cmd_add_command_chars(at_cmd_parser_t *cmd_parser, uint8_t *chars, uint32_t count)
+static void at_cmd_output_cancel(at_cmd_parser_t *cmd_parser, uint32_t index)
 {
-    cy_rslt_t result = CY_RSLT_SUCCESS;
-    uint32_t bytes_used;
-    uint32_t i;
-    int len;
+    cy_rtos_mutex_get(&cmd_parser->output_mutex, CY_RTOS_NEVER_TIMEOUT);
+    at_cmd_output_release(cmd_parser, index, 0);
+    cy_rtos_mutex_set(&cmd_parser->output_mutex);
+}
 
-    if (cmd_parser == NULL || chars == NULL || count == 0)
-    {
-        return CY_AT_CMD_PARSER_BAD_PARAM;
-    }
 
-    if (cmd_parser->cmd_widx + count >= AT_CMD_PARSER_BUFFER_SIZE)
-    {
-        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: input buffer overflow\n");
-        at_cmd_parser_send_cmd_response(0, 1, "Input buffer size exceeded");
-        at_cmd_reset_command_buffer(cmd_parser);
-        return CY_AT_CMD_PARSER_BUFFER_OVERFLOW;
-    }
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+/** Check whether a command is a retransmission of a recent command.
+ *
+ * A command that is not found in the cache is added to it as in flight.
+ * If the response for the original command has already been sent, it is sent again.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the received command.
+ *
+ * @return    true if the command is a retransmission and must not be dispatched.
+ */
 
-    /*
-     * Are we scanning for the command prefix?
-     */
+static bool at_cmd_retransmit_check(at_cmd_parser_t *cmd_parser, uint32_t serial)
+{
+    at_cmd_retransmit_state_t state = AT_CMD_RETRANSMIT_FREE;
+    at_cmd_retransmit_entry_t *entry;
+    at_cmd_retransmit_entry_t *slot = NULL;
+    char text[AT_CMD_RETRANSMIT_CACHE_TEXT_SIZE];
+    uint32_t status = 0;
+    cy_time_t now;
+    int i;
 
-    bytes_used = 0;
-    if (!cmd_parser->reading_cmd)
+    if (serial == 0)
     {
-        bytes_used = at_cmd_scan_for_prefix(cmd_parser, chars, count);
+        return false;
     }
 
-    if (!cmd_parser->reading_cmd)
-    {
-        return CY_RSLT_SUCCESS;
-    }
+    cy_rtos_get_time(&now);
+    cy_rtos_mutex_get(&cmd_parser->retransmit_mutex, CY_RTOS_NEVER_TIMEOUT);
 
-    for (i = bytes_used; i < count; i++)
+    for (i = 0; i < AT_CMD_RETRANSMIT_CACHE_ENTRIES; i++)
     {
-        /*
-         * Are we reading the command header information?
-         */
+        entry = &cmd_parser->retransmit_cache[i];
+        if (entry->state != AT_CMD_RETRANSMIT_FREE && (uint32_t)(now - entry->time) > AT_CMD_RETRANSMIT_WINDOW_MS)
+        {
+            entry->state = AT_CMD_RETRANSMIT_FREE;
+        }
 
-        if (cmd_parser->cmd_header)
+        if (entry->state == AT_CMD_RETRANSMIT_FREE)
         {
-            bytes_used = at_cmd_scan_cmd_header(cmd_parser, &chars[i], count - i);
-            i += bytes_used;
+            if (slot == NULL || slot->state != AT_CMD_RETRANSMIT_FREE)
+            {
+                slot = entry;
+            }
             continue;
         }
 
-        switch (chars[i])
+        if (entry->serial == serial)
         {
-            case 10: /* line feed - ignore it if size is not specified. */
-                if (cmd_parser->cmd_size)
-                {
-                    cmd_parser->command_buffer[cmd_parser->cmd_widx++] = chars[i];
-                }
-                break;
-
-            default:
-                cmd_parser->command_buffer[cmd_parser->cmd_widx] = chars[i];
-                if (!cmd_parser->cmd_size && cmd_parser->command_buffer[cmd_parser->cmd_widx] == '\r')
-                {
-                    /*
-                     * nul terminate the buffer but don't include the trailing nul in the character count.
-                     */
+            state  = entry->state;
+            status = entry->status;
+            strcpy(text, entry->text);
+            break;
+        }
 
-                    cmd_parser->command_buffer[cmd_parser->cmd_widx] = '\0';
+        /*
+         * Remember the oldest entry in case we need to evict one.
+         */
 
-                    result = at_cmd_process_command_buffer(cmd_parser, cmd_parser->command_buffer, cmd_parser->cmd_widx);
-                    at_cmd_reset_command_buffer(cmd_parser);
-                }
-                else if (cmd_parser->cmd_size && cmd_parser->cmd_widx == cmd_parser->cmd_size - 1)
-                {
-                    /*
-                     * nul terminate the buffer but don't include the trailing nul in the character count.
-                     */
+        if (slot == NULL || (slot->state != AT_CMD_RETRANSMIT_FREE && (int32_t)(entry->time - slot->time) < 0))
+        {
+            slot = entry;
+        }
+    }
 
-                    cmd_parser->command_buffer[++cmd_parser->cmd_widx] = '\0';
+    if (state == AT_CMD_RETRANSMIT_FREE)
+    {
+        cmd_parser->retransmit_stats.misses++;
+        slot->state   = AT_CMD_RETRANSMIT_IN_FLIGHT;
+        slot->serial  = serial;
+        slot->time    = now;
+        slot->text[0] = '\0';
+    }
+    else if (state == AT_CMD_RETRANSMIT_IN_FLIGHT)
+    {
+        cmd_parser->retransmit_stats.drops++;
+    }
+    else
+    {
+        cmd_parser->retransmit_stats.hits++;
+    }
 
-                    /*
-                     * Since a command size was specified, it's required that the command string end with ;
-                     */
+    cy_rtos_mutex_set(&cmd_parser->retransmit_mutex);
 
-                    len = cmd_parser->cmd_widx;
-                    if (cmd_parser->command_buffer[len - 1] != AT_CMD_TERMINATOR_CHAR)
-                    {
-                        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: bad cmd trailer\n");
-                        at_cmd_parser_send_cmd_response(0, 1, "bad cmd trailer");
-                        at_cmd_reset_command_buffer(cmd_parser);
-                        return CY_AT_CMD_PARSER_ERROR;
-                    }
-                    result = at_cmd_process_command_buffer(cmd_parser, cmd_parser->command_buffer, len);
-                    at_cmd_reset_command_buffer(cmd_parser);
+    if (state == AT_CMD_RETRANSMIT_COMPLETE)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: resending response for serial %lu\n", serial);
+        at_cmd_send_status(cmd_parser, serial, status, text);
+    }
+    else if (state == AT_CMD_RETRANSMIT_IN_FLIGHT)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: dropping retransmit of serial %lu\n", serial);
+    }
 
-                    /*
-                     * Skip over any trailing whitespace in the buffer.
-                     * Note that i should currently be on the ;.
-                     */
+    return (state != AT_CMD_RETRANSMIT_FREE);
+}
 
-                    while (i + 1 < count && isspace((int)chars[i + 1]))
-                    {
-                        ++i;
-                    }
-                }
-                else
+
+/** Record the response for an in flight command.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] status     : Status value sent for the command.
+ * @param[in] text       : Optional text sent for the command. NULL removes the command from the cache.
+ * @param[in] forget     : true to remove the command from the cache rather than recording the response.
+ */
+
+static void at_cmd_retransmit_update(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t status, char *text, bool forget)
+{
+    at_cmd_retransmit_entry_t *entry;
+    int i;
+
+    if (serial == 0)
+    {
+        return;
+    }
+
+    cy_rtos_mutex_get(&cmd_parser->retransmit_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    for (i = 0; i < AT_CMD_RETRANSMIT_CACHE_ENTRIES; i++)
+    {
+        entry = &cmd_parser->retransmit_cache[i];
+        if (entry->state != AT_CMD_RETRANSMIT_IN_FLIGHT || entry->serial != serial)
+        {
+            continue;
+        }
+
+        if (forget || (text != NULL && strlen(text) >= AT_CMD_RETRANSMIT_CACHE_TEXT_SIZE))
+        {
+            /*
+             * The response text is too large to cache so a retransmit will be dispatched again.
+             */
+
+            entry->state = AT_CMD_RETRANSMIT_FREE;
+            break;
+        }
+
+        entry->state  = AT_CMD_RETRANSMIT_COMPLETE;
+        entry->status = status;
+        cy_rtos_get_time(&entry->time);
+        if (text != NULL)
+        {
+            strcpy(entry->text, text);
+        }
+        break;
+    }
+
+    cy_rtos_mutex_set(&cmd_parser->retransmit_mutex);
+}
+#endif
+
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+/** Find the state kept for registered limits.
+ *
+ * Must be called with the limit mutex held.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] limits     : Limits of a command table entry.
+ *
+ * @return    Pointer to the state or NULL if the limits are not registered.
+ */
+
+static at_cmd_limit_state_t *at_cmd_limit_find_state(at_cmd_parser_t *cmd_parser, const at_cmd_limits_t *limits)
+{
+    int i;
+
+    for (i = 0; i < AT_CMD_LIMIT_ENTRIES; i++)
+    {
+        if (cmd_parser->limit_states[i].limits == limits)
+        {
+            return &cmd_parser->limit_states[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/** Check a command against its limits before the command callback is run.
+ *
+ * A command with an in flight limit takes a tracking entry that is released
+ * when the application answers the command, or when the library answers it
+ * because it could not be passed to the application.
+ *
+ * @param[in]  cmd_parser : Pointer to the main parser structure
+ * @param[in]  limits     : Limits of the command.
+ * @param[in]  serial     : Serial number of the command.
+ * @param[out] entry      : Tracking entry taken for the command, NULL if none was needed.
+ *
+ * @return    NULL if the command is admitted, otherwise the reason it was refused.
+ */
+
+static const char *at_cmd_limit_admit(at_cmd_parser_t *cmd_parser, const at_cmd_limits_t *limits, uint32_t serial, at_cmd_limit_entry_t **entry)
+{
+    at_cmd_limit_state_t *state;
+    const char *reason = NULL;
+    uint64_t refill;
+    uint32_t burst;
+    cy_time_t now;
+    int i;
+
+    *entry = NULL;
+
+    cy_rtos_mutex_get(&cmd_parser->limit_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    /*
+     * The table holding the command may have been unregistered since the command was looked up.
+     */
+
+    state = at_cmd_limit_find_state(cmd_parser, limits);
+    if (state == NULL)
+    {
+        cy_rtos_mutex_set(&cmd_parser->limit_mutex);
+        return NULL;
+    }
+
+    if (state->config.rate != 0)
+    {
+        /*
+         * Token bucket kept as the debt in thousandths of a command, so new
+         * limits start with a full bucket.
+         */
+
+        cy_rtos_get_time(&now);
+        refill = (uint64_t)(uint32_t)(now - state->last_refill) * state->config.rate;
+        state->debt        = (refill >= state->debt) ? 0 : state->debt - (uint32_t)refill;
+        state->last_refill = now;
+
+        burst = (state->config.burst > 0) ? state->config.burst : 1;
+        if (state->debt + 1000 > (uint64_t)burst * 1000)
+        {
+            reason = "Rate limited";
+        }
+    }
+
+    if (reason == NULL && state->config.max_in_flight != 0)
+    {
+        if (state->in_flight >= state->config.max_in_flight)
+        {
+            reason = "Too many in flight";
+        }
+        else
+        {
+            for (i = 0; i < AT_CMD_LIMIT_ENTRIES; i++)
+            {
+                if (cmd_parser->limit_entries[i].state == NULL)
                 {
-                    cmd_parser->cmd_widx++;
+                    *entry = &cmd_parser->limit_entries[i];
+                    break;
                 }
+            }
+
+            if (*entry == NULL)
+            {
+                reason = "Too many in flight";
+            }
+            else
+            {
+                (*entry)->state      = state;
+                (*entry)->serial     = serial;
+                (*entry)->dispatched = false;
+                state->in_flight++;
+            }
+        }
+    }
+
+    if (reason == NULL)
+    {
+        if (state->config.rate != 0)
+        {
+            state->debt += 1000;
+        }
+    }
+    else
+    {
+        state->rejected++;
+    }
+
+    cy_rtos_mutex_set(&cmd_parser->limit_mutex);
+
+    return reason;
+}
+
+
+/** Mark a command as passed to the application.
+ *
+ * From now on the command's entry is released by the application's status response.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] entry      : Tracking entry of the command, NULL if it has none.
+ */
+
+static void at_cmd_limit_dispatch(at_cmd_parser_t *cmd_parser, uint32_t serial, at_cmd_limit_entry_t *entry)
+{
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    cy_rtos_mutex_get(&cmd_parser->limit_mutex, CY_RTOS_NEVER_TIMEOUT);
+    if (entry->state != NULL && entry->serial == serial)
+    {
+        entry->dispatched = true;
+    }
+    cy_rtos_mutex_set(&cmd_parser->limit_mutex);
+}
+
+
+/** Release the in flight limit held by a command.
+ *
+ * Responses carry only the serial number, so an application response releases
+ * one dispatched command with the serial number. Commands in a batch share the
+ * serial number of the batch.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] entry      : Tracking entry to release, NULL to find a dispatched command by serial number.
+ */
+
+static void at_cmd_limit_release(at_cmd_parser_t *cmd_parser, uint32_t serial, at_cmd_limit_entry_t *entry)
+{
+    int i;
+
+    cy_rtos_mutex_get(&cmd_parser->limit_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    for (i = 0; entry == NULL && i < AT_CMD_LIMIT_ENTRIES; i++)
+    {
+        if (cmd_parser->limit_entries[i].state != NULL && cmd_parser->limit_entries[i].dispatched &&
+            cmd_parser->limit_entries[i].serial == serial)
+        {
+            entry = &cmd_parser->limit_entries[i];
+        }
+    }
+
+    /*
+     * The entry is already free, or in use by another command, if its limits were unregistered.
+     */
+
+    if (entry != NULL && entry->state != NULL && entry->serial == serial)
+    {
+        entry->state->in_flight--;
+        entry->state = NULL;
+    }
+
+    cy_rtos_mutex_set(&cmd_parser->limit_mutex);
+}
+
+
+/** Check whether a table set uses limits.
+ *
+ * @param[in] tables : The table set, NULL for no tables.
+ * @param[in] limits : Limits to look for.
+ *
+ * @return    true if an entry of the table set uses the limits.
+ */
+
+static bool at_cmd_limit_in_tables(at_cmd_table_set_t *tables, const at_cmd_limits_t *limits)
+{
+    uint32_t i;
+    uint32_t t;
+
+    for (t = 0; tables != NULL && t < tables->num_tables; t++)
+    {
+        for (i = 0; i < tables->tables[t].num_cmds; i++)
+        {
+            if (tables->tables[t].cmd_table[i].limits == limits)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/** Keep a state for each of the limits used by a table set.
+ *
+ * Called with add set before a new table set is published, to take a state for any new limits,
+ * and with add cleared afterwards to free the state of limits that are no longer used. Commands
+ * in flight under freed limits are forgotten, so nothing refers to an unregistered table.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] tables     : The new table set, NULL for no tables.
+ * @param[in] add        : true to add states, false to free them.
+ *
+ * @return    CY_AT_CMD_PARSER_NO_MEMORY if there are more limits than AT_CMD_LIMIT_ENTRIES.
+ */
+
+static cy_rslt_t at_cmd_limit_update(at_cmd_parser_t *cmd_parser, at_cmd_table_set_t *tables, bool add)
+{
+    const at_cmd_limits_t *limits;
+    at_cmd_limit_state_t *state;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t i;
+    uint32_t t;
+    int j;
+
+    if (cmd_parser->table_mutex_ready)
+    {
+        cy_rtos_mutex_get(&cmd_parser->limit_mutex, CY_RTOS_NEVER_TIMEOUT);
+    }
+
+    for (t = 0; add && tables != NULL && t < tables->num_tables && result == CY_RSLT_SUCCESS; t++)
+    {
+        for (i = 0; i < tables->tables[t].num_cmds; i++)
+        {
+            limits = tables->tables[t].cmd_table[i].limits;
+            if (limits == NULL || at_cmd_limit_find_state(cmd_parser, limits) != NULL)
+            {
+                continue;
+            }
+
+            state = at_cmd_limit_find_state(cmd_parser, NULL);
+            if (state == NULL)
+            {
+                result = CY_AT_CMD_PARSER_NO_MEMORY;
                 break;
+            }
+
+            memset(state, 0, sizeof(at_cmd_limit_state_t));
+            state->limits = limits;
+            state->config = *limits;
+            cy_rtos_get_time(&state->last_refill);
+        }
+    }
+
+    for (j = 0; !add && j < AT_CMD_LIMIT_ENTRIES; j++)
+    {
+        state = &cmd_parser->limit_states[j];
+        if (state->limits == NULL || at_cmd_limit_in_tables(tables, state->limits))
+        {
+            continue;
+        }
+
+        for (i = 0; i < AT_CMD_LIMIT_ENTRIES; i++)
+        {
+            if (cmd_parser->limit_entries[i].state == state)
+            {
+                cmd_parser->limit_entries[i].state = NULL;
+            }
         }
+        state->limits = NULL;
+    }
+
+    if (cmd_parser->table_mutex_ready)
+    {
+        cy_rtos_mutex_set(&cmd_parser->limit_mutex);
+    }
+
+    return result;
+}
+#endif
+
+
+/** Start using the registered command tables.
+ *
+ * Lookups take no lock. The reader records the table epoch it started in so that
+ * a writer knows when a replaced table set can no longer be in use.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] reader     : Reader slot of the calling thread.
+ *
+ * @return    Pointer to the current table set or NULL if no tables are registered.
+ */
+
+static inline at_cmd_table_set_t *at_cmd_tables_enter(at_cmd_parser_t *cmd_parser, uint32_t reader)
+{
+    atomic_store(&cmd_parser->table_reader_epoch[reader], atomic_load(&cmd_parser->table_epoch));
+    return atomic_load(&cmd_parser->cmd_tables);
+}
+
+
+static inline void at_cmd_tables_exit(at_cmd_parser_t *cmd_parser, uint32_t reader)
+{
+    atomic_store_explicit(&cmd_parser->table_reader_epoch[reader], 0, memory_order_release);
+}
+
+
+/** Publish a new set of command tables and free the old set.
+ *
+ * Must be called with the table mutex held.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] tables     : The new table set, NULL for no tables.
+ */
+
+static void at_cmd_tables_publish(at_cmd_parser_t *cmd_parser, at_cmd_table_set_t *tables)
+{
+    at_cmd_table_set_t *old_tables;
+    unsigned int epoch;
+    unsigned int seen;
+    int i;
+
+    old_tables = atomic_exchange(&cmd_parser->cmd_tables, tables);
+
+    /*
+     * Epoch 0 marks an idle reader so skip it when the counter wraps.
+     */
+
+    epoch = atomic_fetch_add(&cmd_parser->table_epoch, 1) + 1;
+    if (epoch == 0)
+    {
+        epoch = atomic_fetch_add(&cmd_parser->table_epoch, 1) + 1;
+    }
+
+    /*
+     * Wait out any reader that started before the new set was published.
+     * Readers only hold the tables for a lookup so this is short.
+     */
+
+    for (i = 0; i < AT_CMD_TABLE_READERS; i++)
+    {
+        while (1)
+        {
+            seen = atomic_load(&cmd_parser->table_reader_epoch[i]);
+            if (seen == 0 || seen == epoch)
+            {
+                break;
+            }
+            cy_rtos_delay_milliseconds(1);
+        }
+    }
+
+    free(old_tables);
+}
+
+
+/** Build a copy of the current table set with a table added, removed or replaced.
+ *
+ * Must be called with the table mutex held.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] old_table  : Table to remove or replace, NULL to add new_table.
+ * @param[in] new_table  : Table to add, NULL to remove old_table.
+ * @param[in] num_cmds   : Number of entries in new_table.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_tables_update(at_cmd_parser_t *cmd_parser, at_cmd_def_t *old_table, at_cmd_def_t *new_table, uint32_t num_cmds)
+{
+    at_cmd_table_set_t *cur_tables;
+    at_cmd_table_set_t *tables;
+    uint32_t num_tables;
+    uint32_t i;
+    uint32_t j;
+    bool found = false;
+
+    cur_tables = atomic_load(&cmd_parser->cmd_tables);
+    num_tables = (cur_tables != NULL) ? cur_tables->num_tables : 0;
+
+    for (i = 0; old_table != NULL && i < num_tables && !found; i++)
+    {
+        found = (cur_tables->tables[i].cmd_table == old_table);
+    }
+
+    if (old_table != NULL && !found)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    if (old_table == NULL)
+    {
+        num_tables++;
+    }
+    else if (new_table == NULL)
+    {
+        num_tables--;
+    }
+
+    if (num_tables == 0)
+    {
+        at_cmd_tables_publish(cmd_parser, NULL);
+#if AT_CMD_LIMIT_ENTRIES > 0
+        at_cmd_limit_update(cmd_parser, NULL, false);
+#endif
+        return CY_RSLT_SUCCESS;
+    }
+
+    tables = malloc(sizeof(at_cmd_table_set_t) + num_tables * sizeof(at_cmd_table_t));
+    if (tables == NULL)
+    {
+        return CY_AT_CMD_PARSER_NO_MEMORY;
+    }
+
+    /*
+     * Replaced tables keep their place so lookup order doesn't change.
+     */
+
+    for (i = 0, j = 0; cur_tables != NULL && i < cur_tables->num_tables; i++)
+    {
+        if (old_table != NULL && cur_tables->tables[i].cmd_table == old_table)
+        {
+            if (new_table != NULL)
+            {
+                tables->tables[j].cmd_table = new_table;
+                tables->tables[j].num_cmds  = num_cmds;
+                j++;
+            }
+            continue;
+        }
+        tables->tables[j++] = cur_tables->tables[i];
+    }
+
+    if (old_table == NULL)
+    {
+        tables->tables[j].cmd_table = new_table;
+        tables->tables[j].num_cmds  = num_cmds;
+        j++;
+    }
+    tables->num_tables = j;
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    if (at_cmd_limit_update(cmd_parser, tables, true) != CY_RSLT_SUCCESS)
+    {
+        at_cmd_limit_update(cmd_parser, cur_tables, false);
+        free(tables);
+        return CY_AT_CMD_PARSER_NO_MEMORY;
+    }
+#endif
+
+    at_cmd_tables_publish(cmd_parser, tables);
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_update(cmd_parser, tables, false);
+#endif
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/** Look up a command in the registered command tables.
+ *
+ * The command definition is copied so that the table can be unregistered
+ * while the command is running.
+ *
+ * @param[in]  cmd_parser : Pointer to the main parser structure
+ * @param[in]  reader     : Reader slot of the calling thread.
+ * @param[in]  name       : Nul terminated command name.
+ * @param[out] cmd        : Copy of the command definition.
+ * @param[out] stream     : Optional copy of the command's streaming callbacks. Zeroed if the command has none.
+ * @param[out] diag       : Optional, set if the command was found in the diagnostic command table.
+ *
+ * @return    true if the command was found.
+ */
+
+static bool at_cmd_find_cmd(at_cmd_parser_t *cmd_parser, uint32_t reader, const char *name, at_cmd_def_t *cmd, at_cmd_stream_callbacks_t *stream,
+                            bool *diag)
+{
+    at_cmd_table_set_t *tables;
+    at_cmd_table_t *table;
+    at_cmd_def_t *found;
+    bool is_diag = false;
+    uint32_t i;
+    uint32_t t;
+    size_t len;
+
+    len    = strlen(name);
+    tables = at_cmd_tables_enter(cmd_parser, reader);
+    for (t = 0, found = NULL; tables != NULL && t < tables->num_tables && found == NULL; t++)
+    {
+        table = &tables->tables[t];
+        for (i = 0; i < table->num_cmds; i++)
+        {
+            if (table->cmd_table[i].cmd_name != NULL && strlen(table->cmd_table[i].cmd_name) == len && !strncmp(name, table->cmd_table[i].cmd_name, len))
+            {
+                found = &table->cmd_table[i];
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+                is_diag = (table->cmd_table == g_at_cmd_diag_table);
+#endif
+                break;
+            }
+        }
+    }
+
+    if (found != NULL)
+    {
+        *cmd = *found;
+        if (stream != NULL)
+        {
+            if (found->stream_callbacks != NULL)
+            {
+                *stream = *found->stream_callbacks;
+            }
+            else
+            {
+                memset(stream, 0, sizeof(at_cmd_stream_callbacks_t));
+            }
+        }
+    }
+    at_cmd_tables_exit(cmd_parser, reader);
+
+    if (diag != NULL)
+    {
+        *diag = is_diag;
+    }
+
+    return (found != NULL);
+}
+
+
+at_cmd_msg_base_t *at_cmd_parse_cmd(at_cmd_parser_t *cmd_parser, uint32_t reader, uint32_t serial, uint32_t cmd_len, uint8_t *cmd_buf,
+                                     bool binary, at_cmd_parse_result_t *result, uint32_t index)
+{
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_entry_t *limit_entry = NULL;
+#endif
+    at_cmd_msg_base_t *msg;
+    at_cmd_def_t cmd;
+    bool diag;
+    uint8_t *ptr;
+
+    if (cmd_buf == NULL)
+    {
+        return NULL;
+    }
+
+    /*
+     * Scan until we find a comma or a nul. Binary data after the comma is never looked at.
+     */
+
+    for (ptr = cmd_buf; ptr < &cmd_buf[cmd_len] && *ptr != '\0'; ptr++)
+    {
+        if (*ptr == ',')
+        {
+            *ptr++ = '\0';
+            break;
+        }
+    }
+
+    /*
+     * Time to find a command match.
+     */
+
+    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: parsing command: %s\n", (char *)cmd_buf);
+
+    if (!at_cmd_find_cmd(cmd_parser, reader, (char *)cmd_buf, &cmd, NULL, &diag) ||
+        (binary ? (cmd.binary_parser == NULL) : (cmd.cmd_parser == NULL && cmd.inline_parser == NULL)))
+    {
+        /*
+         * Didn't find a matching command.
+         */
+
+        return NULL;
+    }
+
+    result->cmd_class[index] = (cmd.cmd_class < AT_CMD_MAX_CMD_CLASSES) ? cmd.cmd_class : 0;
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    result->diag[index]      = diag;
+#endif
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    /*
+     * Refuse the command before the callback allocates anything for it.
+     */
+
+    if (cmd.limits != NULL && (result->reject[index] = at_cmd_limit_admit(cmd_parser, cmd.limits, serial, &limit_entry)) != NULL)
+    {
+        return NULL;
+    }
+#endif
+
+    /*
+     * Invoke the command callback.
+     */
+
+    if (binary)
+    {
+        msg = cmd.binary_parser(cmd.cmd_id, serial, ptr, cmd_len - (uint32_t)(ptr - cmd_buf));
+    }
+    else if (cmd.inline_parser != NULL)
+    {
+        msg = cmd.inline_parser(cmd.cmd_id, serial, cmd_len - (uint32_t)(ptr - cmd_buf), ptr,
+                                (cmd_parser->inline_msg_size > 0) ? &result->inline_msg[index].base : NULL, cmd_parser->inline_msg_size);
+    }
+    else
+    {
+        msg = cmd.cmd_parser(cmd.cmd_id, serial, cmd_len - (uint32_t)(ptr - cmd_buf), ptr);
+    }
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    if (msg == NULL && limit_entry != NULL)
+    {
+        /*
+         * An invalid command is answered without a status response for the serial number.
+         */
+
+        at_cmd_limit_release(cmd_parser, serial, limit_entry);
+    }
+    else
+    {
+        result->limit[index] = limit_entry;
+    }
+#endif
+
+    return msg;
+}
+
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+/** Parse the commands in a batch.
+ *
+ * The batch arguments are a list of commands, each with optional arguments,
+ * separated by AT_CMD_BATCH_SEPARATOR characters.
+ *
+ * @param[in]  cmd_parser : Pointer to the main parser structure
+ * @param[in]  reader     : Reader slot of the calling thread.
+ * @param[in]  serial     : Serial number of the batch.
+ * @param[in]  cmd_len    : Length of the batch arguments.
+ * @param[in]  cmd_buf    : Pointer to the nul terminated batch arguments.
+ * @param[out] result     : Messages for the commands in the batch.
+ */
+
+static void at_cmd_parse_batch(at_cmd_parser_t *cmd_parser, uint32_t reader, uint32_t serial, uint32_t cmd_len, uint8_t *cmd_buf, at_cmd_parse_result_t *result)
+{
+    uint8_t *entry;
+    uint32_t count;
+    uint32_t i;
+
+    /*
+     * Make sure the whole batch fits before running any of the commands.
+     */
+
+    for (i = 0, count = 1; i < cmd_len; i++)
+    {
+        if (cmd_buf[i] == AT_CMD_BATCH_SEPARATOR)
+        {
+            count++;
+        }
+    }
+
+    if (cmd_len == 0 || count > AT_CMD_BATCH_MAX_ENTRIES)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid batch with %lu entries\n", count);
+        return;
+    }
+
+    for (i = 0, entry = cmd_buf; i <= cmd_len; i++)
+    {
+        if (i < cmd_len && cmd_buf[i] != AT_CMD_BATCH_SEPARATOR)
+        {
+            continue;
+        }
+
+        cmd_buf[i] = '\0';
+        result->msg[result->count] = at_cmd_parse_cmd(cmd_parser, reader, serial, (uint32_t)(&cmd_buf[i] - entry), entry, false,
+                                                      result, result->count);
+        result->count++;
+        entry = &cmd_buf[i + 1];
+    }
+}
+#endif
+
+
+/** Parse a command, or each command of a batch, and run the command callbacks.
+ *
+ * @param[in]  cmd_parser : Pointer to the main parser structure
+ * @param[in]  reader     : Reader slot of the calling thread.
+ * @param[in]  serial     : Serial number of the command.
+ * @param[in]  cmd_len    : Length of the command.
+ * @param[in]  cmd_buf    : Pointer to the nul terminated command name and arguments.
+ * @param[in]  binary     : The arguments are binary data for the command's binary callback.
+ * @param[out] result     : Messages returned by the command callbacks.
+ */
+
+static void at_cmd_parse_command(at_cmd_parser_t *cmd_parser, uint32_t reader, uint32_t serial, uint32_t cmd_len, uint8_t *cmd_buf,
+                                 bool binary, at_cmd_parse_result_t *result)
+{
+    memset(result, 0, sizeof(at_cmd_parse_result_t));
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+    if (!binary && cmd_len > sizeof(AT_CMD_BATCH_CMD_NAME) - 1 && cmd_buf[sizeof(AT_CMD_BATCH_CMD_NAME) - 1] == ',' &&
+        !strncmp((char *)cmd_buf, AT_CMD_BATCH_CMD_NAME, sizeof(AT_CMD_BATCH_CMD_NAME) - 1))
+    {
+        result->batch = true;
+        at_cmd_parse_batch(cmd_parser, reader, serial, cmd_len - sizeof(AT_CMD_BATCH_CMD_NAME), &cmd_buf[sizeof(AT_CMD_BATCH_CMD_NAME)], result);
+        return;
+    }
+#endif
+
+    result->msg[0] = at_cmd_parse_cmd(cmd_parser, reader, serial, cmd_len, cmd_buf, binary, result, 0);
+    result->count  = 1;
+}
+
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+/** Start collecting the responses for a batch.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the batch.
+ * @param[in] count      : Number of commands in the batch.
+ *
+ * @return    false if too many batches are already waiting for responses.
+ */
+
+static bool at_cmd_batch_start(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t count)
+{
+    at_cmd_batch_t *batch;
+    bool started = false;
+    int i;
+
+    cy_rtos_mutex_get(&cmd_parser->batch_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    for (i = 0; i < AT_CMD_MAX_BATCHES; i++)
+    {
+        batch = &cmd_parser->batches[i];
+        if (batch->active)
+        {
+            continue;
+        }
+
+        memset(&batch->rsp, 0, sizeof(batch->rsp));
+        batch->rsp.buffer = batch->text;
+        batch->rsp.size   = sizeof(batch->text) - 1;
+        at_cmd_parser_json_array_begin(&batch->rsp, NULL);
+
+        batch->active  = true;
+        batch->serial  = serial;
+        batch->pending = count;
+        batch->status  = AT_CMD_STATUS_SUCCESS;
+        started        = true;
+        break;
+    }
+
+    cy_rtos_mutex_set(&cmd_parser->batch_mutex);
+
+    return started;
+}
+
+
+/** Add a command response to a batch.
+ *
+ * Once all of the commands in the batch have responded, the combined response is sent.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the response.
+ * @param[in] status     : Status value of the response.
+ * @param[in] text       : Optional response text.
+ * @param[in] rsp        : Response builder holding the text, NULL if none. The builder's
+ *                         output is released once the text is added to the batch.
+ *
+ * @return    false if the serial number does not belong to a batch waiting for responses.
+ */
+
+static bool at_cmd_batch_add_result(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t status, char *text, at_cmd_response_t *rsp)
+{
+    at_cmd_batch_t *batch = NULL;
+    bool complete;
+    int i;
+
+    cy_rtos_mutex_get(&cmd_parser->batch_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    for (i = 0; i < AT_CMD_MAX_BATCHES; i++)
+    {
+        if (cmd_parser->batches[i].active && cmd_parser->batches[i].pending > 0 && cmd_parser->batches[i].serial == serial)
+        {
+            batch = &cmd_parser->batches[i];
+            break;
+        }
+    }
+
+    if (batch == NULL)
+    {
+        cy_rtos_mutex_set(&cmd_parser->batch_mutex);
+        return false;
+    }
+
+    at_cmd_parser_json_object_begin(&batch->rsp, NULL);
+    at_cmd_parser_json_add_uint(&batch->rsp, "status", status);
+    if (text != NULL && text[0] != '\0')
+    {
+        at_cmd_parser_json_add_string(&batch->rsp, "text", text);
+    }
+    at_cmd_parser_json_object_end(&batch->rsp);
+
+    if (batch->status == AT_CMD_STATUS_SUCCESS)
+    {
+        batch->status = status;
+    }
+
+    complete = (--batch->pending == 0);
+    if (complete)
+    {
+        at_cmd_parser_json_array_end(&batch->rsp);
+    }
+
+    cy_rtos_mutex_set(&cmd_parser->batch_mutex);
+
+    /*
+     * The text has been copied so the builder's output is free for the batch response.
+     */
+
+    at_cmd_response_abort(rsp);
+
+    if (!complete)
+    {
+        return true;
+    }
+
+    /*
+     * That was the last one. The batch can't match any more responses
+     * so we can send it without holding the mutex.
+     */
+
+    if (batch->rsp.overflow)
+    {
+        at_cmd_send_status(cmd_parser, serial, (batch->status != AT_CMD_STATUS_SUCCESS) ? batch->status : AT_CMD_STATUS_ERROR,
+                           "Batch response too large");
+    }
+    else
+    {
+        batch->text[batch->rsp.len] = '\0';
+        at_cmd_send_status(cmd_parser, serial, batch->status, batch->text);
+    }
+
+    cy_rtos_mutex_get(&cmd_parser->batch_mutex, CY_RTOS_NEVER_TIMEOUT);
+    batch->active = false;
+    cy_rtos_mutex_set(&cmd_parser->batch_mutex);
+
+    return true;
+}
+#endif
+
+
+/** Send the error response for one or more errors.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number for the response, 0 if not known.
+ * @param[in] text       : Text of the most recent error.
+ * @param[in] count      : Number of errors the response covers.
+ */
+
+static void at_cmd_send_errors(at_cmd_parser_t *cmd_parser, uint32_t serial, const char *text, uint32_t count)
+{
+    char buf[64];
+    uint32_t len;
+
+    if (count == 1)
+    {
+        at_cmd_send_status(cmd_parser, serial, AT_CMD_STATUS_ERROR, (char *)text);
+        return;
+    }
+
+    len = at_cmd_format_uint(buf, count);
+    snprintf(&buf[len], sizeof(buf) - len, " framing errors, last: %s", text);
+    at_cmd_send_status(cmd_parser, serial, AT_CMD_STATUS_ERROR, buf);
+}
+
+
+/** Report framing or command errors to the host.
+ *
+ * With AT_CMD_ERROR_EVENTS set the errors are recorded and sent later by the error thread,
+ * so the input thread never waits for the output. Repeated errors are coalesced.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number for the response, 0 if not known.
+ * @param[in] text       : Text of the most recent error. Must be a string constant.
+ * @param[in] count      : Number of errors being reported.
+ */
+
+static void at_cmd_report_errors(at_cmd_parser_t *cmd_parser, uint32_t serial, const char *text, uint32_t count)
+{
+#if AT_CMD_ERROR_EVENTS > 0
+    at_cmd_error_event_t *last = NULL;
+
+    cy_rtos_mutex_get(&cmd_parser->error_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    if (cmd_parser->error_count > 0)
+    {
+        last = &cmd_parser->error_events[(cmd_parser->error_head + cmd_parser->error_count - 1) % AT_CMD_ERROR_EVENTS];
+    }
+
+    if (last != NULL && last->serial == serial && last->text == text)
+    {
+        last->count += count;
+    }
+    else if (cmd_parser->error_count == AT_CMD_ERROR_EVENTS)
+    {
+        /*
+         * No room. Fold the error into the newest event, which no longer belongs to one command.
+         */
+
+        last->count += count;
+        last->serial = 0;
+        last->text   = text;
+    }
+    else
+    {
+        last = &cmd_parser->error_events[(cmd_parser->error_head + cmd_parser->error_count) % AT_CMD_ERROR_EVENTS];
+        last->serial = serial;
+        last->count  = count;
+        last->text   = text;
+        cmd_parser->error_count++;
+    }
+
+    cy_rtos_mutex_set(&cmd_parser->error_mutex);
+    cy_rtos_semaphore_set(&cmd_parser->error_sem);
+#else
+    at_cmd_send_errors(cmd_parser, serial, text, count);
+#endif
+}
+
+
+/** Report a framing or command error to the host.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number for the response, 0 if not known.
+ * @param[in] text       : Error text. Must be a string constant.
+ */
+
+static void at_cmd_report_error(at_cmd_parser_t *cmd_parser, uint32_t serial, const char *text)
+{
+    at_cmd_report_errors(cmd_parser, serial, text, 1);
+}
+
+
+/** Report an error found by the framer.
+ *
+ * Errors found while rescanning the data of a discarded frame are counted and reported
+ * together when the rescan is done. Data made up of many short bad frames would otherwise
+ * cost an error response every few bytes.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Framer that found the error.
+ * @param[in] text       : Error text. Must be a string constant.
+ */
+
+static void at_cmd_framing_error(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, const char *text)
+{
+    if (framer->resyncing)
+    {
+        framer->resync_errors++;
+        framer->resync_error = text;
+        return;
+    }
+
+    at_cmd_report_error(cmd_parser, 0, text);
+}
+
+
+/** Check whether the deadline of a command message has passed.
+ *
+ * @param[in] msg : Pointer to the command message.
+ *
+ * @return    true if the message has a deadline and it has passed.
+ */
+
+static bool at_cmd_deadline_expired(at_cmd_msg_base_t *msg)
+{
+    cy_time_t now;
+
+    if (msg->timeout_ms == 0)
+    {
+        return false;
+    }
+
+    cy_rtos_get_time(&now);
+
+    return (uint32_t)(now - msg->rx_time) >= msg->timeout_ms;
+}
+
+
+/** Deliver a parsed command message to the application.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] msg        : Message returned by the command callback or NULL if the command was invalid.
+ * @param[in] cmd_class  : Routing class of the command.
+ * @param[in] is_inline  : The message was built in inline message space and is copied into the queue entry.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_deliver_msg(at_cmd_parser_t *cmd_parser, uint32_t serial, at_cmd_msg_base_t *msg, uint32_t cmd_class, bool is_inline)
+{
+    at_cmd_msg_queue_entry_t msg_queue_entry;
+    cy_queue_t *queue;
+    cy_rslt_t result;
+
+    if (msg == NULL)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid cmd\n");
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+        at_cmd_retransmit_update(cmd_parser, serial, 0, NULL, true);
+#endif
+        at_cmd_report_error(cmd_parser, 0, "Invalid cmd");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    if (at_cmd_deadline_expired(msg))
+    {
+        /*
+         * The host has given up on the command so don't let it take up queue space.
+         */
+
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: dropping expired cmd %lu\n", serial);
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+        at_cmd_retransmit_update(cmd_parser, serial, 0, NULL, true);
+#endif
+        at_cmd_send_status(cmd_parser, serial, AT_CMD_STATUS_TIMEOUT, "Deadline expired");
+        if (!is_inline)
+        {
+            free(msg);
+        }
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    /*
+     * Send it off to the queue for the command's class.
+     */
+
+    memset(&msg_queue_entry, 0, AT_CMD_MSG_QUEUE_ENTRY_SIZE(cmd_parser->inline_msg_size));
+    if (is_inline)
+    {
+        memcpy(&msg_queue_entry.raw[sizeof(at_cmd_msg_queue_t)], msg, cmd_parser->inline_msg_size);
+    }
+    else
+    {
+        msg_queue_entry.entry.msg = msg;
+    }
+
+    queue = cmd_parser->class_msg_queue[cmd_class];
+    if (queue == NULL)
+    {
+        queue = cmd_parser->msg_queue;
+    }
+
+    /*
+     * Input pushed from an application event loop must not block waiting for queue space.
+     */
+
+    if ((result = cy_rtos_queue_put(queue, &msg_queue_entry, (cmd_parser->read_data != NULL) ? AT_CMD_MSG_QUEUE_TIMEOUT : 0)) != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: error sending msg\n");
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+        at_cmd_retransmit_update(cmd_parser, serial, 0, NULL, true);
+#endif
+        at_cmd_send_status(cmd_parser, serial, AT_CMD_STATUS_BUSY, "queue full");
+        if (!is_inline)
+        {
+            free(msg);
+        }
+    }
+
+    return result;
+}
+
+
+/** Deliver the message of one command of a parse result to the application.
+ *
+ * The command keeps its in flight limit until the application answers it. If the
+ * message can't be delivered the library answers the command and the limit is released.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] result     : Messages returned by the command callbacks.
+ * @param[in] index      : Index of the command in the result.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_deliver_entry(at_cmd_parser_t *cmd_parser, uint32_t serial, at_cmd_parse_result_t *result, uint32_t index)
+{
+    cy_rslt_t status;
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    if (result->msg[index] != NULL && result->diag[index])
+    {
+        /*
+         * Diagnostic commands bypass the application so they measure the transport and parser alone.
+         */
+
+        at_cmd_diag_run(cmd_parser, result->msg[index]);
+        return CY_RSLT_SUCCESS;
+    }
+#endif
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_dispatch(cmd_parser, serial, result->limit[index]);
+#endif
+
+    status = at_cmd_deliver_msg(cmd_parser, serial, result->msg[index], result->cmd_class[index],
+                                result->msg[index] == &result->inline_msg[index].base);
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    if (status != CY_RSLT_SUCCESS && result->limit[index] != NULL)
+    {
+        at_cmd_limit_release(cmd_parser, serial, result->limit[index]);
+    }
+#endif
+
+    return status;
+}
+
+
+/** Deliver the messages for a command or batch of commands to the application.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] result     : Messages returned by the command callbacks.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_deliver_result(at_cmd_parser_t *cmd_parser, uint32_t serial, at_cmd_parse_result_t *result)
+{
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+    cy_rslt_t status = CY_RSLT_SUCCESS;
+#endif
+    uint32_t i;
+
+    for (i = 0; i < result->count; i++)
+    {
+        if (result->msg[i] != NULL)
+        {
+            result->msg[i]->rx_time    = result->rx_time;
+            result->msg[i]->timeout_ms = result->timeout_ms;
+        }
+    }
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+    if (result->batch)
+    {
+        if (result->count == 0 || !at_cmd_batch_start(cmd_parser, serial, result->count))
+        {
+            for (i = 0; i < result->count; i++)
+            {
+                if (result->msg[i] != &result->inline_msg[i].base)
+                {
+                    free(result->msg[i]);
+                }
+#if AT_CMD_LIMIT_ENTRIES > 0
+                if (result->limit[i] != NULL)
+                {
+                    at_cmd_limit_release(cmd_parser, serial, result->limit[i]);
+                }
+#endif
+            }
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+            at_cmd_retransmit_update(cmd_parser, serial, 0, NULL, true);
+#endif
+            at_cmd_send_status(cmd_parser, serial, (result->count == 0) ? AT_CMD_STATUS_ERROR : AT_CMD_STATUS_BUSY,
+                               (result->count == 0) ? "Invalid batch" : "Too many batches");
+            return CY_AT_CMD_PARSER_ERROR;
+        }
+
+        /*
+         * Invalid commands are answered as part of the batch. Everything else
+         * is answered by the application, or by us if the queue is full.
+         */
+
+        for (i = 0; i < result->count; i++)
+        {
+            if (result->msg[i] == NULL)
+            {
+                at_cmd_batch_add_result(cmd_parser, serial, (result->reject[i] != NULL) ? AT_CMD_STATUS_BUSY : AT_CMD_STATUS_ERROR,
+                                        (result->reject[i] != NULL) ? (char *)result->reject[i] : "Invalid cmd", NULL);
+                status = CY_AT_CMD_PARSER_ERROR;
+            }
+            else if (at_cmd_deliver_entry(cmd_parser, serial, result, i) != CY_RSLT_SUCCESS)
+            {
+                status = CY_AT_CMD_PARSER_ERROR;
+            }
+        }
+
+        return status;
+    }
+#endif
+
+    if (result->msg[0] == NULL && result->reject[0] != NULL)
+    {
+        /*
+         * Refused by the command's limits. The host may retry once it has fewer commands outstanding.
+         */
+
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: cmd %lu refused: %s\n", serial, result->reject[0]);
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+        at_cmd_retransmit_update(cmd_parser, serial, 0, NULL, true);
+#endif
+        at_cmd_send_status(cmd_parser, serial, AT_CMD_STATUS_BUSY, (char *)result->reject[0]);
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    return at_cmd_deliver_entry(cmd_parser, serial, result, 0);
+}
+
+
+#if AT_CMD_NUM_WORKERS > 0
+/** Deliver completed jobs in the order the commands were received.
+ *
+ * Must be called with the job mutex held. The mutex is released while each job is
+ * delivered, since delivery can wait for queue space and for the transport. Only one
+ * worker delivers at a time so the order is kept. A worker that finishes a job while
+ * another is delivering leaves the job for that worker.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ */
+
+static void at_cmd_deliver_jobs(at_cmd_parser_t *cmd_parser)
+{
+    at_cmd_job_t *job;
+
+    if (cmd_parser->job_delivering)
+    {
+        return;
+    }
+    cmd_parser->job_delivering = true;
+
+    while (1)
+    {
+        job = &cmd_parser->jobs[cmd_parser->job_order[cmd_parser->deliver_seq % AT_CMD_WORKER_JOBS]];
+        if (job->state != AT_CMD_JOB_DONE || job->seq != cmd_parser->deliver_seq)
+        {
+            break;
+        }
+
+        /*
+         * The job stays in the done state while it is delivered so its slot isn't reused.
+         */
+
+        cy_rtos_mutex_set(&cmd_parser->job_mutex);
+        at_cmd_deliver_result(cmd_parser, job->serial, &job->result);
+        cy_rtos_mutex_get(&cmd_parser->job_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+        job->state = AT_CMD_JOB_FREE;
+        cmd_parser->deliver_seq++;
+        cy_rtos_semaphore_set(&cmd_parser->job_free_sem);
+    }
+
+    cmd_parser->job_delivering = false;
+}
+
+
+static void at_cmd_worker_thread_func(cy_thread_arg_t arg)
+{
+    at_cmd_parser_t *cmd_parser = (at_cmd_parser_t *)arg;
+    at_cmd_job_t *job;
+    uint32_t reader;
+    uint32_t idx;
+
+    reader = AT_CMD_TABLE_READER_INPUT + 1 + atomic_fetch_add(&cmd_parser->table_next_reader, 1);
+
+    while (1)
+    {
+        if (cy_rtos_queue_get(&cmd_parser->job_queue, &idx, CY_RTOS_NEVER_TIMEOUT) != CY_RSLT_SUCCESS)
+        {
+            continue;
+        }
+
+        /*
+         * Run the command callback. This is the part that runs in parallel.
+         */
+
+        job = &cmd_parser->jobs[idx];
+        at_cmd_parse_command(cmd_parser, reader, job->serial, job->len, job->buffer, job->binary, &job->result);
+        job->result.rx_time    = job->rx_time;
+        job->result.timeout_ms = job->timeout_ms;
+
+        cy_rtos_mutex_get(&cmd_parser->job_mutex, CY_RTOS_NEVER_TIMEOUT);
+        job->state = AT_CMD_JOB_DONE;
+        at_cmd_deliver_jobs(cmd_parser);
+        cy_rtos_mutex_set(&cmd_parser->job_mutex);
+    }
+}
+
+
+/** Hand a command off to the worker threads.
+ *
+ * Waits for a free job if all of them are in use.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] cmd_len    : Length of the command.
+ * @param[in] cmd_buf    : Pointer to the nul terminated command name and arguments.
+ * @param[in] binary     : The arguments are binary data.
+ * @param[in] rx_time    : Time the command was received.
+ * @param[in] timeout_ms : Deadline of the command relative to rx_time, 0 for none.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_submit_job(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t cmd_len, uint8_t *cmd_buf, bool binary,
+                                   cy_time_t rx_time, uint32_t timeout_ms)
+{
+    at_cmd_job_t *job = NULL;
+    cy_rslt_t result;
+    uint32_t idx;
+
+    result = cy_rtos_semaphore_get(&cmd_parser->job_free_sem, CY_RTOS_NEVER_TIMEOUT);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    cy_rtos_mutex_get(&cmd_parser->job_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    for (idx = 0; idx < AT_CMD_WORKER_JOBS; idx++)
+    {
+        if (cmd_parser->jobs[idx].state == AT_CMD_JOB_FREE)
+        {
+            job = &cmd_parser->jobs[idx];
+            break;
+        }
+    }
+
+    if (job == NULL)
+    {
+        cy_rtos_mutex_set(&cmd_parser->job_mutex);
+        cy_rtos_semaphore_set(&cmd_parser->job_free_sem);
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    job->state  = AT_CMD_JOB_PENDING;
+    job->seq    = cmd_parser->job_seq++;
+    job->serial = serial;
+    job->len    = cmd_len;
+    job->binary = binary;
+    job->rx_time    = rx_time;
+    job->timeout_ms = timeout_ms;
+    memcpy(job->buffer, cmd_buf, cmd_len);
+    job->buffer[cmd_len] = '\0';
+    cmd_parser->job_order[job->seq % AT_CMD_WORKER_JOBS] = (uint8_t)idx;
+
+    cy_rtos_mutex_set(&cmd_parser->job_mutex);
+
+    return cy_rtos_queue_put(&cmd_parser->job_queue, &idx, CY_RTOS_NEVER_TIMEOUT);
+}
+#endif
+
+
+/** Process a command buffer.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] buffer     : Pointer to the command message buffer.
+ * @param[in] count      : Number of bytes of data in message buffer.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_process_command_buffer(at_cmd_parser_t *cmd_parser, uint8_t *buffer, uint32_t count)
+{
+#if AT_CMD_NUM_WORKERS == 0
+    at_cmd_parse_result_t result;
+#endif
+    char *ptr;
+    char *end;
+    uint32_t serial;
+    uint32_t size;
+    uint32_t timeout_ms;
+    cy_time_t rx_time;
+#ifdef ENABLE_AT_CMD_ECHO
+    uint32_t output_index;
+    uint32_t echo_len;
+#endif
+    uint32_t hdr;
+    bool binary;
+    int i;
+
+    /*
+     * Binary commands have a marker after the prefix. Their data isn't text so
+     * it isn't logged or echoed.
+     */
+
+    binary = (count > AT_CMD_PREFIX_CHARS && buffer[AT_CMD_PREFIX_CHARS] == AT_CMD_BINARY_MARKER_CHAR);
+    hdr    = binary ? AT_CMD_PREFIX_CHARS + 1 : AT_CMD_PREFIX_CHARS;
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    atomic_fetch_add_explicit(&cmd_parser->diag.rx_frames, 1, memory_order_relaxed);
+#endif
+
+    if (!binary)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: incoming command: %s\n", (char *)buffer);
+    }
+
+#ifdef ENABLE_AT_CMD_ECHO
+    if (!binary)
+    {
+        /*
+         * Echo the AT command.
+         */
+
+        if (at_cmd_output_acquire(cmd_parser, AT_CMD_OUTPUT_CLASS_ECHO, &output_index) == CY_RSLT_SUCCESS)
+        {
+            echo_len = (count > AT_CMD_PARSER_BUFFER_SIZE - 2) ? AT_CMD_PARSER_BUFFER_SIZE - 2 : count;
+            memcpy(cmd_parser->output[output_index].buffer, buffer, echo_len);
+            memcpy(&cmd_parser->output[output_index].buffer[echo_len], "\n\r", 2);
+            at_cmd_output_send(cmd_parser, output_index, echo_len + 2);
+        }
+    }
+#endif
+
+    /*
+     * Make sure we have a valid message header.
+     */
+
+    if (count < hdr + AT_CMD_SIZE_CHARS + 1 || strncmp((const char *)buffer, cmd_parser->at_cmd_prefix, AT_CMD_PREFIX_CHARS))
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid msg header: %.*s\n", AT_CMD_MIN_HEADER_SIZE, (char *)buffer);
+        at_cmd_report_error(cmd_parser, 0, "Invalid command");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    /*
+     * Extract the data size.
+     */
+
+    for (size = 0, i = 0; i < AT_CMD_SIZE_CHARS; i++)
+    {
+        if (!isdigit(buffer[hdr + i]))
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid size digit %c\n", buffer[hdr + i]);
+            at_cmd_report_error(cmd_parser, 0, "Invalid size digit");
+            return CY_AT_CMD_PARSER_ERROR;
+        }
+        size = (size * 10) + buffer[hdr + i] - '0';
+    }
+
+    if (size > AT_CMD_MAX_SIZE)
+    {
+        at_cmd_report_error(cmd_parser, 0, "Invalid size");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    /*
+     * There must be a serial number specified.
+     */
+
+    ptr = (char *)&buffer[hdr + AT_CMD_SIZE_CHARS];
+    serial = 0;
+    while (isdigit((int)*ptr))
+    {
+        serial = (serial * 10) + (*ptr++) - '0';
+    }
+
+    /*
+     * The host may give a deadline in milliseconds. It is measured from now.
+     */
+
+    cy_rtos_get_time(&rx_time);
+    timeout_ms = 0;
+    if (*ptr == AT_CMD_DEADLINE_CHAR)
+    {
+        ptr++;
+        while (isdigit((int)*ptr))
+        {
+            timeout_ms = (timeout_ms * 10) + (*ptr++) - '0';
+        }
+    }
+
+    if (*ptr != AT_CMD_TERMINATOR_CHAR)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid msg separator: %c\n", *ptr);
+        at_cmd_report_error(cmd_parser, 0, "Invalid format");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+    ptr++;
+
+    /*
+     * Strip off the trailing ;
+     */
+
+    end = (char *)&buffer[count - 1];
+    if (*end == AT_CMD_TERMINATOR_CHAR)
+    {
+        *end = 0;
+        count--;
+    }
+
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+    /*
+     * Don't run a retransmitted command a second time.
+     */
+
+    if (at_cmd_retransmit_check(cmd_parser, serial))
+    {
+        return CY_RSLT_SUCCESS;
+    }
+#endif
+
+    /*
+     * Send the command to the command parser.
+     */
+
+#if AT_CMD_NUM_WORKERS > 0
+    return at_cmd_submit_job(cmd_parser, serial, count - (uint32_t)((uint8_t *)ptr - buffer), (uint8_t *)ptr, binary, rx_time, timeout_ms);
+#else
+    at_cmd_parse_command(cmd_parser, AT_CMD_TABLE_READER_INPUT, serial, count - (uint32_t)((uint8_t *)ptr - buffer), (uint8_t *)ptr, binary, &result);
+    result.rx_time    = rx_time;
+    result.timeout_ms = timeout_ms;
+
+    return at_cmd_deliver_result(cmd_parser, serial, &result);
+#endif
+}
+
+
+#ifdef ENABLE_AT_CMD_STREAMING
+/** Set up to read the body of a streamed command once its header is complete.
+ *
+ * @param[in] framer : Reassembly state of the input channel.
+ */
+
+static void at_cmd_stream_start(at_cmd_framer_t *framer)
+{
+    uint32_t i;
+
+    framer->stream_serial = 0;
+    for (i = framer->size_end; i < framer->cmd_widx - 1 && isdigit(framer->command_buffer[i]); i++)
+    {
+        framer->stream_serial = (framer->stream_serial * 10) + framer->command_buffer[i] - '0';
+    }
+
+    /*
+     * The deadline is measured from the header, like the deadline of a framed command.
+     */
+
+    cy_rtos_get_time(&framer->stream_rx_time);
+    framer->stream_timeout_ms = 0;
+    if (framer->command_buffer[i] == AT_CMD_DEADLINE_CHAR)
+    {
+        for (i++; i < framer->cmd_widx - 1 && isdigit(framer->command_buffer[i]); i++)
+        {
+            framer->stream_timeout_ms = (framer->stream_timeout_ms * 10) + framer->command_buffer[i] - '0';
+        }
+    }
+#if AT_CMD_LIMIT_ENTRIES > 0
+    framer->stream_limit = NULL;
+#endif
+
+    framer->stream_state     = AT_CMD_STREAM_NAME;
+    framer->stream_remaining = framer->cmd_size;
+    framer->stream_name      = framer->cmd_widx;
+    framer->stream_context   = NULL;
+    framer->stream_open      = false;
+
+    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: streamed cmd size %lu\n", framer->cmd_size);
+}
+
+
+/** Release what a streamed command holds once it won't reach the application.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Reassembly state of the input channel.
+ */
+
+static void at_cmd_stream_release(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer)
+{
+#if AT_CMD_LIMIT_ENTRIES > 0
+    if (framer->stream_limit != NULL)
+    {
+        at_cmd_limit_release(cmd_parser, framer->stream_serial, framer->stream_limit);
+        framer->stream_limit = NULL;
+    }
+#endif
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+    at_cmd_retransmit_update(cmd_parser, framer->stream_serial, 0, NULL, true);
+#endif
+
+    (void)cmd_parser;
+    (void)framer;
+}
+
+
+/** Find a streamed command and call its begin callback.
+ *
+ * The command is admitted the same way as a framed command: a retransmission is
+ * answered from the retransmit cache and the command's limits are checked before
+ * the begin callback is called.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Reassembly state of the input channel.
+ */
+
+static void at_cmd_stream_open(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer)
+{
+#if AT_CMD_LIMIT_ENTRIES > 0
+    const char *reason;
+#endif
+    at_cmd_def_t cmd;
+    char *name;
+
+    name = (char *)&framer->command_buffer[framer->stream_name];
+    framer->command_buffer[framer->cmd_widx] = '\0';
+
+    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: streamed command: %s\n", name);
+
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+    /*
+     * Don't run a retransmitted stream a second time. Its data is dropped.
+     */
+
+    if (at_cmd_retransmit_check(cmd_parser, framer->stream_serial))
+    {
+        framer->stream_state = AT_CMD_STREAM_DISCARD;
+        return;
+    }
+#endif
+
+    if (!at_cmd_find_cmd(cmd_parser, AT_CMD_TABLE_READER_INPUT, name, &cmd, &framer->stream, NULL) ||
+        framer->stream.begin == NULL || framer->stream.data == NULL || framer->stream.end == NULL)
+    {
+        at_cmd_stream_release(cmd_parser, framer);
+        at_cmd_report_error(cmd_parser, framer->stream_serial, "Invalid cmd");
+        framer->stream_state = AT_CMD_STREAM_DISCARD;
+        return;
+    }
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    if (cmd.limits != NULL && (reason = at_cmd_limit_admit(cmd_parser, cmd.limits, framer->stream_serial, &framer->stream_limit)) != NULL)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: cmd %lu refused: %s\n", framer->stream_serial, reason);
+        at_cmd_stream_release(cmd_parser, framer);
+        at_cmd_send_status(cmd_parser, framer->stream_serial, AT_CMD_STATUS_BUSY, (char *)reason);
+        framer->stream_state = AT_CMD_STREAM_DISCARD;
+        return;
+    }
+#endif
+
+    framer->stream_class = (cmd.cmd_class < AT_CMD_MAX_CMD_CLASSES) ? cmd.cmd_class : 0;
+    if (framer->stream.begin(cmd.cmd_id, framer->stream_serial, framer->stream_remaining, &framer->stream_context) != CY_RSLT_SUCCESS)
+    {
+        at_cmd_stream_release(cmd_parser, framer);
+        at_cmd_report_error(cmd_parser, framer->stream_serial, "Stream rejected");
+        framer->stream_state = AT_CMD_STREAM_DISCARD;
+        return;
+    }
+
+    framer->stream_open  = true;
+    framer->stream_state = AT_CMD_STREAM_DATA;
+}
+
+
+/** Finish a streamed command.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Reassembly state of the input channel.
+ * @param[in] complete   : true if all of the data and the trailer were received.
+ */
+
+static void at_cmd_stream_close(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, bool complete)
+{
+    at_cmd_msg_base_t *msg;
+
+    if (!framer->stream_open)
+    {
+        return;
+    }
+    framer->stream_open = false;
+
+    msg = framer->stream.end(framer->stream_context, complete);
+    if (!complete)
+    {
+        free(msg);
+        at_cmd_stream_release(cmd_parser, framer);
+        return;
+    }
+
+    if (msg != NULL)
+    {
+        msg->rx_time    = framer->stream_rx_time;
+        msg->timeout_ms = framer->stream_timeout_ms;
+    }
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_dispatch(cmd_parser, framer->stream_serial, framer->stream_limit);
+#endif
+
+    /*
+     * Once delivered the limit is released by the application's response.
+     */
+
+    if (at_cmd_deliver_msg(cmd_parser, framer->stream_serial, msg, framer->stream_class, false) != CY_RSLT_SUCCESS)
+    {
+        at_cmd_stream_release(cmd_parser, framer);
+    }
+#if AT_CMD_LIMIT_ENTRIES > 0
+    framer->stream_limit = NULL;
+#endif
+}
+
+
+/** Pass the body of a streamed command on to the command callbacks.
+ *
+ * Only the command name is buffered. The data goes straight from the input
+ * to the data callback so the command can be any size.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Reassembly state of the input channel.
+ * @param[in] chars      : Pointer to the characters to add.
+ * @param[in] count      : Number of characters to add.
+ *
+ * @return    Number of characters consumed. A bad trailer character is not consumed.
+ */
+
+static uint32_t at_cmd_stream_chars(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, uint8_t *chars, uint32_t count)
+{
+    uint32_t len;
+    uint32_t i = 0;
+
+    while (i < count)
+    {
+        switch (framer->stream_state)
+        {
+            case AT_CMD_STREAM_NAME:
+                if (framer->stream_remaining > 0 && chars[i] != ',')
+                {
+                    /*
+                     * Leave room for the terminator; a long serial number may have filled most of the buffer.
+                     */
+
+                    if (framer->cmd_widx - framer->stream_name >= AT_CMD_STREAM_MAX_NAME ||
+                        framer->cmd_widx >= AT_CMD_PARSER_BUFFER_SIZE - 1)
+                    {
+                        at_cmd_report_error(cmd_parser, framer->stream_serial, "Invalid cmd");
+                        framer->stream_state = AT_CMD_STREAM_DISCARD;
+                        break;
+                    }
+                    framer->command_buffer[framer->cmd_widx++] = chars[i++];
+                    framer->stream_remaining--;
+                    break;
+                }
+
+                if (framer->stream_remaining > 0)
+                {
+                    /*
+                     * Skip the ',' between the name and the data.
+                     */
+
+                    framer->stream_remaining--;
+                    i++;
+                }
+                at_cmd_stream_open(cmd_parser, framer);
+                break;
+
+            case AT_CMD_STREAM_DATA:
+            case AT_CMD_STREAM_DISCARD:
+                if (framer->stream_remaining == 0)
+                {
+                    framer->stream_state = AT_CMD_STREAM_TRAILER;
+                    break;
+                }
+
+                len = count - i;
+                if (len > framer->stream_remaining)
+                {
+                    len = framer->stream_remaining;
+                }
+
+                if (framer->stream_state == AT_CMD_STREAM_DATA &&
+                    framer->stream.data(framer->stream_context, &chars[i], len) != CY_RSLT_SUCCESS)
+                {
+                    at_cmd_stream_close(cmd_parser, framer, false);
+                    at_cmd_report_error(cmd_parser, framer->stream_serial, "Stream aborted");
+                    framer->stream_state = AT_CMD_STREAM_DISCARD;
+                }
+
+                framer->stream_remaining -= len;
+                i += len;
+                break;
+
+            case AT_CMD_STREAM_TRAILER:
+                if (chars[i] != AT_CMD_TERMINATOR_CHAR)
+                {
+                    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: bad streamed cmd trailer\n");
+                    if (framer->stream_open)
+                    {
+                        at_cmd_stream_close(cmd_parser, framer, false);
+                        at_cmd_report_error(cmd_parser, framer->stream_serial, "bad cmd trailer");
+                    }
+                    at_cmd_reset_command_buffer(framer);
+                    return i;
+                }
+
+                at_cmd_stream_close(cmd_parser, framer, true);
+                at_cmd_reset_command_buffer(framer);
+                return i + 1;
+        }
+    }
+
+    return i;
+}
+#endif
+
+
+/** Scan the command header.
+ *
+ * The header is the command data size followed by the serial number and a ';'.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Reassembly state of the input channel.
+ * @param[in] chars      : Pointer to the characters to scan.
+ * @param[in] count      : Number of characters to scan.
+ *
+ * @return    Number of characters consumed. If the header is invalid the
+ *            parser is reset and the offending character is not consumed.
+ */
+
+static uint32_t at_cmd_scan_cmd_header(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, uint8_t *chars, uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        /*
+         * Don't let an endless serial number run off the end of the buffer.
+         */
+
+        if (framer->cmd_widx >= AT_CMD_PARSER_BUFFER_SIZE - 1)
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: input buffer overflow\n");
+            at_cmd_framing_error(cmd_parser, framer, "Input buffer size exceeded");
+            at_cmd_reset_command_buffer(framer);
+
+            return i;
+        }
+
+        /*
+         * Are we extracting the command length field?
+         */
+
+        if (framer->cmd_widx < framer->size_end)
+        {
+            if (framer->cmd_widx == AT_CMD_PREFIX_CHARS && chars[i] == AT_CMD_BINARY_MARKER_CHAR)
+            {
+                framer->binary   = true;
+                framer->size_end = AT_CMD_PREFIX_CHARS + 1 + AT_CMD_SIZE_CHARS;
+                framer->command_buffer[framer->cmd_widx++] = chars[i];
+                continue;
+            }
+#ifdef ENABLE_AT_CMD_STREAMING
+            if (framer->cmd_widx == AT_CMD_PREFIX_CHARS && chars[i] == AT_CMD_STREAM_MARKER_CHAR)
+            {
+                framer->streaming = true;
+                framer->size_end  = AT_CMD_PREFIX_CHARS + 1 + AT_CMD_STREAM_SIZE_CHARS;
+                framer->command_buffer[framer->cmd_widx++] = chars[i];
+                continue;
+            }
+#endif
+            if (!isdigit(chars[i]))
+            {
+                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid size digit %c\n", chars[i]);
+                at_cmd_framing_error(cmd_parser, framer, "Invalid size digit");
+                at_cmd_reset_command_buffer(framer);
+
+                return i;
+            }
+            framer->cmd_size = (framer->cmd_size * 10) + chars[i] - '0';
+            framer->command_buffer[framer->cmd_widx++] = chars[i];
+            continue;
+        }
+
+        /*
+         * We need at least one digit for the serial number.
+         * After that it's just digits until we hit the ';' character.
+         */
+
+        if ((framer->cmd_widx == framer->size_end) && !isdigit(chars[i]))
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid serial number digit %c\n", chars[i]);
+            at_cmd_framing_error(cmd_parser, framer, "Invalid serial digit");
+            at_cmd_reset_command_buffer(framer);
+
+            return i;
+        }
+        else if (chars[i] == AT_CMD_DEADLINE_CHAR && !framer->deadline)
+        {
+            /*
+             * An optional deadline in milliseconds follows the serial number.
+             */
+
+            framer->deadline = true;
+        }
+        else if ((!isdigit(chars[i]) && chars[i] != AT_CMD_TERMINATOR_CHAR) ||
+                 (chars[i] == AT_CMD_TERMINATOR_CHAR && framer->command_buffer[framer->cmd_widx - 1] == AT_CMD_DEADLINE_CHAR))
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid format %c\n", chars[i]);
+            at_cmd_framing_error(cmd_parser, framer, "Invalid format");
+            at_cmd_reset_command_buffer(framer);
+
+            return i;
+        }
+
+        framer->command_buffer[framer->cmd_widx++] = chars[i];
+
+        if (chars[i] == AT_CMD_TERMINATOR_CHAR)
+        {
+            framer->cmd_header = false;
+#ifdef ENABLE_AT_CMD_STREAMING
+            if (framer->streaming)
+            {
+                at_cmd_stream_start(framer);
+                return i + 1;
+            }
+#endif
+            if (framer->binary && framer->cmd_size == 0)
+            {
+                /*
+                 * Binary data can't be ended by a line terminator.
+                 */
+
+                at_cmd_framing_error(cmd_parser, framer, "Invalid size");
+                at_cmd_reset_command_buffer(framer);
+                return i + 1;
+            }
+            if (framer->cmd_size > 0)
+            {
+                /*
+                 * The specified command size is the number of characters between the ';'
+                 * characters. Add in what we've buffered so far and the trailing
+                 * ';' to the total size.
+                 */
+
+                framer->cmd_size += framer->cmd_widx + 1;
+                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: Total cmd size %lu\n", framer->cmd_size);
+
+                /*
+                 * Make sure the command and the trailing nul fit in the input buffer.
+                 */
+
+                if (framer->cmd_size >= AT_CMD_PARSER_BUFFER_SIZE)
+                {
+                    at_cmd_framing_error(cmd_parser, framer, "Input buffer size exceeded");
+                    at_cmd_reset_command_buffer(framer);
+                }
+            }
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: Header complete\n");
+
+            return i + 1;
+        }
+    }
+
+    return i;
+}
+
+
+static uint32_t at_cmd_scan_for_prefix(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, uint8_t *chars, uint32_t count)
+{
+    uint8_t *next;
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (framer->at_cmd_prefix_idx == 0 && chars[i] != cmd_parser->at_cmd_prefix[0])
+        {
+            /*
+             * Skip line noise up to the next possible command start in one go.
+             */
+
+            next = memchr(&chars[i], cmd_parser->at_cmd_prefix[0], count - i);
+            if (next == NULL)
+            {
+                return count;
+            }
+            i = (uint32_t)(next - chars);
+        }
+
+#if AT_CMD_NUM_CHANNELS > 1
+        if (framer == &cmd_parser->framer[0] && framer->at_cmd_prefix_idx == AT_CMD_PREFIX_CHARS - 1 && chars[i] == AT_CMD_CHANNEL_CHAR)
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: Channel chunk start detected\n");
+            framer->at_cmd_prefix_idx = 0;
+            framer->cmd_widx          = 0;
+            cmd_parser->chunk_state   = AT_CMD_CHUNK_CHANNEL;
+            cmd_parser->chunk_channel = 0;
+            cmd_parser->chunk_size    = 0;
+            cmd_parser->chunk_digits  = 0;
+            i++;
+            break;
+        }
+#endif
+
+        if (chars[i] == cmd_parser->at_cmd_prefix[framer->at_cmd_prefix_idx])
+        {
+            framer->command_buffer[framer->cmd_widx++] = chars[i];
+            if (++framer->at_cmd_prefix_idx == AT_CMD_PREFIX_CHARS)
+            {
+                at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG1, "AT CMD: Command start detected\n");
+                framer->at_cmd_prefix_idx = 0;
+                framer->reading_cmd       = true;
+                framer->cmd_header        = true;
+                i++;
+                break;
+            }
+        }
+        else
+        {
+            if ((framer->at_cmd_prefix_idx > 0) && (chars[i] == cmd_parser->at_cmd_prefix[0]))
+            {
+                /*
+                 * Special case. We were processing a command start sequence and received a bad character.
+                 * But the character matches the start of a possible command start sequence. We need to
+                 * save it rather than throwing it away.
+                 */
+
+                framer->command_buffer[0] = chars[i];
+                framer->at_cmd_prefix_idx = 1;
+                framer->cmd_widx          = 1;
+            }
+            else
+            {
+                framer->at_cmd_prefix_idx = 0;
+                framer->cmd_widx          = 0;
+            }
+        }
+    }
+
+    return i;
+}
+
+
+#if AT_CMD_NUM_CHANNELS > 1
+/** Scan a channel chunk frame.
+ *
+ * The frame is AT%<channel>,<size>; followed by size bytes of data for the channel.
+ * The data is added to the channel's own command buffer, so commands sent on
+ * different channels can be interleaved a chunk at a time.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] chars      : Pointer to the characters to scan.
+ * @param[in] count      : Number of characters to scan.
+ *
+ * @return    Number of characters consumed. If the chunk header is invalid the
+ *            offending character is not consumed.
+ */
+
+static uint32_t at_cmd_scan_channel_chunk(at_cmd_parser_t *cmd_parser, uint8_t *chars, uint32_t count)
+{
+    uint32_t len;
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (cmd_parser->chunk_state == AT_CMD_CHUNK_DATA)
+        {
+            len = count - i;
+            if (len > cmd_parser->chunk_size)
+            {
+                len = cmd_parser->chunk_size;
+            }
+
+            cmd_parser->chunk_size -= len;
+            if (cmd_parser->chunk_size == 0)
+            {
+                cmd_parser->chunk_state = AT_CMD_CHUNK_NONE;
+            }
+            at_cmd_add_command_chars(cmd_parser, &cmd_parser->framer[cmd_parser->chunk_channel], &chars[i], len);
+
+            return i + len;
+        }
+
+        if (cmd_parser->chunk_state == AT_CMD_CHUNK_CHANNEL)
+        {
+            if (isdigit(chars[i]) && cmd_parser->chunk_channel < AT_CMD_NUM_CHANNELS)
+            {
+                cmd_parser->chunk_channel = (cmd_parser->chunk_channel * 10) + chars[i] - '0';
+                cmd_parser->chunk_digits++;
+                continue;
+            }
+
+            if (chars[i] == ',' && cmd_parser->chunk_digits > 0 &&
+                cmd_parser->chunk_channel > 0 && cmd_parser->chunk_channel < AT_CMD_NUM_CHANNELS)
+            {
+                cmd_parser->chunk_state  = AT_CMD_CHUNK_SIZE;
+                cmd_parser->chunk_digits = 0;
+                continue;
+            }
+        }
+        else if (cmd_parser->chunk_digits < AT_CMD_SIZE_CHARS)
+        {
+            if (isdigit(chars[i]))
+            {
+                cmd_parser->chunk_size = (cmd_parser->chunk_size * 10) + chars[i] - '0';
+                cmd_parser->chunk_digits++;
+                continue;
+            }
+        }
+        else if (chars[i] == AT_CMD_TERMINATOR_CHAR)
+        {
+            cmd_parser->chunk_state = (cmd_parser->chunk_size > 0) ? AT_CMD_CHUNK_DATA : AT_CMD_CHUNK_NONE;
+            continue;
+        }
+
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: invalid channel chunk %c\n", chars[i]);
+        at_cmd_report_error(cmd_parser, 0, "Invalid channel chunk");
+        cmd_parser->chunk_state = AT_CMD_CHUNK_NONE;
+
+        return i;
+    }
+
+    return i;
+}
+#endif
+
+
+/** Recover from a sized command with a bad trailer.
+ *
+ * The declared size was wrong so the command may have swallowed the start of
+ * the next command. Scan the buffered data again, starting after the first
+ * character of the bad command. Binary commands are dropped without a rescan.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Reassembly state of the input channel.
+ * @param[in] len        : Number of characters in the command buffer.
+ */
+
+static void at_cmd_resync_command_buffer(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, uint32_t len)
+{
+    bool binary = framer->binary;
+
+    at_cmd_reset_command_buffer(framer);
+
+    /*
+     * Only go one level deep so that a hostile stream can't make us rescan
+     * the same data over and over. A binary payload is opaque data and is
+     * never scanned for commands.
+     */
+
+    if (binary || framer->resyncing || len < 2)
+    {
+        return;
+    }
+
+    /*
+     * Rescanning writes to the command buffer at or behind the read position
+     * so we can feed the buffer back into itself.
+     */
+
+    framer->resyncing     = true;
+    framer->resync_errors = 0;
+    at_cmd_add_command_chars(cmd_parser, framer, &framer->command_buffer[1], len - 1);
+    framer->resyncing     = false;
+
+    if (framer->resync_errors > 0)
+    {
+        at_cmd_report_errors(cmd_parser, 0, framer->resync_error, framer->resync_errors);
+    }
+}
+
+
+/** Add characters to the incoming command buffer.
+ *
+ * Characters are processed one at a time. After an error the parser resumes
+ * looking for the next command with the character following the error, so a
+ * single call may contain any mix of commands and noise.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] framer     : Reassembly state of the input channel.
+ * @param[in] chars      : Pointer to the characters to add.
+ * @param[in] count      : Number of characters to add.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_add_command_chars(at_cmd_parser_t *cmd_parser, at_cmd_framer_t *framer, uint8_t *chars, uint32_t count)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t i;
+    int len;
+
+    if (cmd_parser == NULL || chars == NULL || count == 0)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    i = 0;
+    while (i < count)
+    {
+#if AT_CMD_NUM_CHANNELS > 1
+        /*
+         * Are we in the middle of a chunk for another channel?
+         */
+
+        if (cmd_parser->chunk_state != AT_CMD_CHUNK_NONE && framer == &cmd_parser->framer[0])
+        {
+            i += at_cmd_scan_channel_chunk(cmd_parser, &chars[i], count - i);
+            continue;
+        }
+#endif
+
+        /*
+         * Are we scanning for the command prefix?
+         */
+
+        if (!framer->reading_cmd)
+        {
+            i += at_cmd_scan_for_prefix(cmd_parser, framer, &chars[i], count - i);
+            continue;
+        }
+
+        /*
+         * Are we reading the command header information?
+         */
+
+        if (framer->cmd_header)
+        {
+            i += at_cmd_scan_cmd_header(cmd_parser, framer, &chars[i], count - i);
+            continue;
+        }
+
+#ifdef ENABLE_AT_CMD_STREAMING
+        if (framer->streaming)
+        {
+            i += at_cmd_stream_chars(cmd_parser, framer, &chars[i], count - i);
+            continue;
+        }
+#endif
+
+        /*
+         * Leave room for the trailing nul. Sized commands complete or fail at their
+         * trailer position, so this only catches a command without a size that never ends.
+         */
+
+        if (framer->cmd_widx >= AT_CMD_PARSER_BUFFER_SIZE - 1)
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: input buffer overflow\n");
+            at_cmd_framing_error(cmd_parser, framer, "Input buffer size exceeded");
+            at_cmd_reset_command_buffer(framer);
+            result = CY_AT_CMD_PARSER_BUFFER_OVERFLOW;
+            continue;
+        }
+
+        switch (chars[i])
+        {
+            case 10: /* line feed - ignore it if size is not specified. */
+                if (!framer->cmd_size)
+                {
+                    break;
+                }
+
+                /*
+                 * A sized command counts the line feed like any other character,
+                 * including in the trailer position.
+                 */
+
+                /* fall through */
+            default:
+                framer->command_buffer[framer->cmd_widx] = chars[i];
+                if (!framer->cmd_size && framer->command_buffer[framer->cmd_widx] == '\r')
+                {
+                    /*
+                     * nul terminate the buffer but don't include the trailing nul in the character count.
+                     */
+
+                    framer->command_buffer[framer->cmd_widx] = '\0';
+
+                    result = at_cmd_process_command_buffer(cmd_parser, framer->command_buffer, framer->cmd_widx);
+                    at_cmd_reset_command_buffer(framer);
+                }
+                else if (framer->cmd_size && framer->cmd_widx == framer->cmd_size - 1)
+                {
+                    /*
+                     * nul terminate the buffer but don't include the trailing nul in the character count.
+                     */
+
+                    framer->command_buffer[++framer->cmd_widx] = '\0';
+
+                    /*
+                     * Since a command size was specified, it's required that the command string end with ;
+                     */
+
+                    len = framer->cmd_widx;
+                    if (framer->command_buffer[len - 1] != AT_CMD_TERMINATOR_CHAR)
+                    {
+                        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: bad cmd trailer\n");
+                        at_cmd_framing_error(cmd_parser, framer, "bad cmd trailer");
+                        at_cmd_resync_command_buffer(cmd_parser, framer, len);
+                        result = CY_AT_CMD_PARSER_ERROR;
+                        break;
+                    }
+                    result = at_cmd_process_command_buffer(cmd_parser, framer->command_buffer, len);
+                    at_cmd_reset_command_buffer(framer);
+                }
+                else
+                {
+                    framer->cmd_widx++;
+                }
+                break;
+        }
+        i++;
+    }
+
+    return result;
+}
+
+
+static uint32_t at_cmd_queue_credits(at_cmd_parser_t *cmd_parser)
+{
+    size_t spaces;
+
+    if (cy_rtos_queue_space(cmd_parser->msg_queue, &spaces) != CY_RSLT_SUCCESS)
+    {
+        return 0;
+    }
+
+    return (uint32_t)spaces;
+}
+
+
+/** Send a Credits message with the number of free command queue entries.
+ *
+ * @param[in] credits : Number of free entries.
+ *
+ * @return    true if the message was sent.
+ */
+
+static bool at_cmd_send_credits(uint32_t credits)
+{
+    at_cmd_response_t rsp;
+
+    if (at_cmd_parser_async_response_begin(&rsp, 0, AT_CMD_CREDITS_MSG_NAME) != CY_RSLT_SUCCESS)
+    {
+        return false;
+    }
+
+    at_cmd_parser_json_object_begin(&rsp, NULL);
+    at_cmd_parser_json_add_uint(&rsp, "credits", credits);
+    at_cmd_parser_json_object_end(&rsp);
+
+    return (at_cmd_parser_response_send(&rsp) == CY_RSLT_SUCCESS);
+}
+
+
+/** Advertise the number of free command queue entries to the host.
+ *
+ * With AT_CMD_ERROR_EVENTS set the count is handed to the error thread, so the input
+ * thread never waits for the output. Otherwise it is sent from here. Either way changes
+ * are coalesced and at most one message is sent every AT_CMD_CREDITS_MIN_INTERVAL_MS.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] credits    : Number of free entries.
+ */
+
+static void at_cmd_advertise_credits(at_cmd_parser_t *cmd_parser, uint32_t credits)
+{
+#if AT_CMD_ERROR_EVENTS > 0
+    bool changed;
+
+    cy_rtos_mutex_get(&cmd_parser->error_mutex, CY_RTOS_NEVER_TIMEOUT);
+    changed = (credits != cmd_parser->credits_pending);
+    cmd_parser->credits_pending = credits;
+    cy_rtos_mutex_set(&cmd_parser->error_mutex);
+
+    if (changed)
+    {
+        cy_rtos_semaphore_set(&cmd_parser->error_sem);
+    }
+#else
+    cy_time_t now;
+
+    if (credits == cmd_parser->credits_advertised)
+    {
+        return;
+    }
+
+    /*
+     * The time is taken whether or not the message goes out, so a busy output
+     * is retried once per interval rather than on every check.
+     */
+
+    cy_rtos_get_time(&now);
+    if ((uint32_t)(now - cmd_parser->credits_time) < AT_CMD_CREDITS_MIN_INTERVAL_MS)
+    {
+        return;
+    }
+    cmd_parser->credits_time = now;
+
+    if (at_cmd_send_credits(credits))
+    {
+        cmd_parser->credits_advertised = credits;
+    }
+#endif
+}
+
+
+/** Check the command message queue and apply flow control.
+ *
+ * Tells the transport to stop input when the queue is full and to resume it
+ * once the application has made room. If credit messages are enabled the host
+ * is also told the number of free queue entries as it changes, starting with
+ * the initial window.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ *
+ * @return    true if input is stopped.
+ */
+
+static bool at_cmd_check_flow_control(at_cmd_parser_t *cmd_parser)
+{
+    uint32_t credits;
+    bool full;
+
+    if (cmd_parser->flow_control == NULL && !cmd_parser->advertise_credits)
+    {
+        return false;
+    }
+
+    credits = at_cmd_queue_credits(cmd_parser);
+    full    = (credits == 0);
+    if (full != cmd_parser->queue_full)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: command queue %s\n", full ? "full" : "available");
+        cmd_parser->queue_full = full;
+        if (cmd_parser->flow_control != NULL)
+        {
+            cmd_parser->flow_control(full, cmd_parser->opaque);
+        }
+    }
+
+    if (cmd_parser->advertise_credits)
+    {
+        at_cmd_advertise_credits(cmd_parser, credits);
+    }
+
+    return (full && cmd_parser->flow_control != NULL);
+}
+
+
+#if AT_CMD_ERROR_EVENTS > 0
+/** Error thread. Sends the error responses recorded by at_cmd_report_error() and
+ * the Credits messages handed over by at_cmd_advertise_credits().
+ *
+ * @param[in] arg : Pointer to the main parser structure
+ */
+
+static void at_cmd_error_thread_func(cy_thread_arg_t arg)
+{
+    at_cmd_parser_t *cmd_parser = (at_cmd_parser_t *)arg;
+    at_cmd_error_event_t event;
+    uint32_t credits;
+
+    while (1)
+    {
+        cy_rtos_semaphore_get(&cmd_parser->error_sem, CY_RTOS_NEVER_TIMEOUT);
+
+        while (1)
+        {
+            cy_rtos_mutex_get(&cmd_parser->error_mutex, CY_RTOS_NEVER_TIMEOUT);
+            if (cmd_parser->error_count == 0)
+            {
+                cy_rtos_mutex_set(&cmd_parser->error_mutex);
+                break;
+            }
+            event = cmd_parser->error_events[cmd_parser->error_head];
+            cmd_parser->error_head = (cmd_parser->error_head + 1) % AT_CMD_ERROR_EVENTS;
+            cmd_parser->error_count--;
+            cy_rtos_mutex_set(&cmd_parser->error_mutex);
+
+            at_cmd_send_errors(cmd_parser, event.serial, event.text, event.count);
+
+            /*
+             * Limit the rate of error responses. Errors arriving meanwhile are coalesced.
+             */
+
+            cy_rtos_delay_milliseconds(AT_CMD_ERROR_MIN_INTERVAL_MS);
+        }
+
+        /*
+         * Send the latest free entry count. Changes made while we wait for the
+         * output or the interval are coalesced into the next message.
+         */
+
+        cy_rtos_mutex_get(&cmd_parser->error_mutex, CY_RTOS_NEVER_TIMEOUT);
+        credits = cmd_parser->credits_pending;
+        cy_rtos_mutex_set(&cmd_parser->error_mutex);
+
+        if (cmd_parser->advertise_credits && credits != cmd_parser->credits_advertised)
+        {
+            if (at_cmd_send_credits(credits))
+            {
+                cmd_parser->credits_advertised = credits;
+            }
+            else
+            {
+                cy_rtos_semaphore_set(&cmd_parser->error_sem);
+            }
+            cy_rtos_delay_milliseconds(AT_CMD_CREDITS_MIN_INTERVAL_MS);
+        }
+    }
+}
+#endif
+
+
+static void at_cmd_input_thread_func(cy_thread_arg_t arg)
+{
+    at_cmd_parser_t *cmd_parser = (at_cmd_parser_t *)arg;
+    uint32_t read_size = INPUT_READ_SIZE_MIN;
+    uint32_t drained;
+    uint32_t count;
+    uint8_t buffer[INPUT_BUFFER_SIZE];
+
+    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: Input thread starting\n");
+    while (1)
+    {
+        /*
+         * Don't read any more commands while the application has no room for them.
+         */
+
+        if (at_cmd_check_flow_control(cmd_parser))
+        {
+            cy_rtos_delay_milliseconds(1);
+            continue;
+        }
+
+        /* Check if host sent any data */
+        if (!cmd_parser->is_data_ready(cmd_parser->opaque))
+        {
+            /*
+             * No data waiting. Sleep for a bit before checking again.
+             */
+
+            cy_rtos_delay_milliseconds(1);
+            continue;
+        }
+
+        /*
+         * Drain everything that is available. Stop after INPUT_DRAIN_LIMIT bytes
+         * so that sustained input doesn't starve other threads.
+         */
+
+        drained = 0;
+        do
+        {
+            count = cmd_parser->read_data(buffer, read_size, cmd_parser->opaque);
+            if (0 == count)
+            {
+                break;
+            }
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+            atomic_fetch_add_explicit(&cmd_parser->diag.rx_bytes, count, memory_order_relaxed);
+            atomic_fetch_add_explicit(&cmd_parser->diag.rx_reads, 1, memory_order_relaxed);
+#endif
+
+            at_cmd_add_command_chars(cmd_parser, &cmd_parser->framer[0], buffer, count);
+            drained += count;
+
+            /*
+             * Size reads to match the bursts we are seeing. Grow when a read fills
+             * the request and shrink when reads come back mostly empty, so transports
+             * that wait for the full request don't hold up short commands.
+             */
+
+            if (count == read_size && read_size < INPUT_BUFFER_SIZE)
+            {
+                read_size = (read_size * 2 > INPUT_BUFFER_SIZE) ? INPUT_BUFFER_SIZE : read_size * 2;
+            }
+            else if (count < read_size / 4 && read_size > INPUT_READ_SIZE_MIN)
+            {
+                read_size = (read_size / 2 < INPUT_READ_SIZE_MIN) ? INPUT_READ_SIZE_MIN : read_size / 2;
+            }
+        } while (drained < INPUT_DRAIN_LIMIT && !at_cmd_check_flow_control(cmd_parser) &&
+                 cmd_parser->is_data_ready(cmd_parser->opaque));
+
+        if (drained >= INPUT_DRAIN_LIMIT)
+        {
+            cy_rtos_delay_milliseconds(1);
+        }
+    }
+}
+
+
+/** Reserve the output and write the frame header.
+ *
+ * @param[out] rsp      : Pointer to the response builder.
+ * @param[in]  msg_type : Frame type character.
+ * @param[in]  serial   : Serial number for the message.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_response_start(at_cmd_response_t *rsp, char msg_type, uint32_t serial)
+{
+    cy_rslt_t result;
+    char *ptr;
+    int i;
+
+    if (rsp == NULL)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    memset(rsp, 0, sizeof(at_cmd_response_t));
+    rsp->output_class = (msg_type == AT_CMD_STATUS_MSG_TYPE) ? AT_CMD_OUTPUT_CLASS_STATUS : AT_CMD_OUTPUT_CLASS_ASYNC;
+
+    /*
+     * Make sure no one else is using the output buffer.
+     */
+
+    result = at_cmd_output_acquire(&g_cmd_parser, rsp->output_class, &rsp->output_index);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error acquiring output\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    /*
+     * We need to construct the proper message header.
+     * Allow 4 digits for the message size, it gets filled in when the message is sent.
+     */
+
+    ptr = (char *)g_cmd_parser.output[rsp->output_index].buffer;
+    *ptr++ = '+';
+    *ptr++ = msg_type;
+    for (i = 0; i < AT_CMD_SIZE_CHARS; i++)
+    {
+        *ptr++ = '0';
+    }
+
+    /*
+     * Add in the serial number.
+     */
+
+    *ptr++ = ',';
+    ptr   += at_cmd_format_uint(ptr, serial);
+    *ptr++ = ';';
+
+    rsp->buffer     = (char *)g_cmd_parser.output[rsp->output_index].buffer;
+    rsp->size       = AT_CMD_PARSER_BUFFER_SIZE - AT_CMD_TRAILER_CHARS;
+    rsp->len        = (uint32_t)(ptr - rsp->buffer);
+    rsp->data_start = rsp->len;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/** Release the output without sending anything.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ */
+
+static void at_cmd_response_abort(at_cmd_response_t *rsp)
+{
+    if (rsp != NULL && rsp->buffer != NULL)
+    {
+        rsp->buffer = NULL;
+        at_cmd_output_cancel(&g_cmd_parser, rsp->output_index);
+    }
+}
+
+
+/** Fill in the length, send the message and release the output.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_response_finish(at_cmd_response_t *rsp)
+{
+    uint32_t data_bytes;
+    char *size;
+    int i;
+
+    if (rsp == NULL || rsp->buffer == NULL)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    data_bytes = rsp->len - rsp->data_start;
+    if (rsp->overflow || data_bytes > AT_CMD_MAX_SIZE)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: output message too large\n");
+        at_cmd_response_abort(rsp);
+        return CY_AT_CMD_PARSER_BUFFER_OVERFLOW;
+    }
+
+    /*
+     * Add in the data size and the trailing ';'
+     */
+
+    size = &rsp->buffer[2 + AT_CMD_SIZE_CHARS - 1];
+    for (i = 0; i < AT_CMD_SIZE_CHARS; i++)
+    {
+        *size-- = (data_bytes % 10) + '0';
+        data_bytes /= 10;
+    }
+
+    rsp->buffer[rsp->len++] = ';';
+    rsp->buffer[rsp->len++] = '\r';
+    rsp->buffer[rsp->len++] = '\n';
+    rsp->buffer[rsp->len]   = '\0';
+
+    /*
+     * Send the message off to the external host. The output buffer is released for
+     * the next sender once the transport has written it.
+     */
+
+    rsp->buffer = NULL;
+
+    return at_cmd_output_send(&g_cmd_parser, rsp->output_index, rsp->len);
+}
+
+
+/** Update the state kept for a command when its status response is sent.
+ *
+ * Used for every status response, whether it is sent from a string or built in place.
+ * In flight limits are released by the callers that answer for the application.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the response.
+ * @param[in] status     : Status value of the response.
+ * @param[in] text       : Optional response text.
+ * @param[in] rsp        : Response builder holding the text, NULL if none.
+ *
+ * @return    true if the response was added to a batch and must not be sent.
+ */
+
+static bool at_cmd_response_complete(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t status, char *text, at_cmd_response_t *rsp)
+{
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+    /*
+     * Responses for commands in a batch are combined into one response for the batch.
+     */
+
+    if (at_cmd_batch_add_result(cmd_parser, serial, status, text, rsp))
+    {
+        return true;
+    }
+#else
+    (void)rsp;
+#endif
+
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+    at_cmd_retransmit_update(cmd_parser, serial, status, text, false);
+#endif
+
+    (void)cmd_parser;
+    (void)serial;
+    (void)status;
+    (void)text;
+
+    return false;
+}
+
+
+static cy_rslt_t at_cmd_send_host_message(bool async_msg, bool compress, uint32_t serial, uint32_t status, char *text)
+{
+    at_cmd_response_t rsp;
+    cy_rslt_t result;
+    uint32_t text_len;
+    char *ptr;
+
+    result = at_cmd_response_start(&rsp, async_msg ? AT_CMD_ASYNC_MSG_TYPE : AT_CMD_STATUS_MSG_TYPE, serial);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    text_len = (text != NULL) ? strlen(text) : 0;
+
+    if (!async_msg)
+    {
+        /*
+         * Add in the status value and any optional message text.
+         */
+
+        ptr      = &rsp.buffer[rsp.len];
+        rsp.len += at_cmd_format_uint(ptr, status);
+
+        rsp.sep_pending = true;
+        at_cmd_parser_response_append(&rsp, text, text_len);
+    }
+    else
+    {
+#ifdef ENABLE_AT_CMD_COMPRESSION
+        if ((compress || g_cmd_parser.compress_async) && text_len >= AT_CMD_COMPRESS_MIN_SIZE)
+        {
+            uint32_t limit;
+            uint32_t chars;
+
+            /*
+             * Only use the compressed form if it is actually smaller.
+             */
+
+            limit = rsp.size - rsp.len;
+            if (limit > text_len - 1)
+            {
+                limit = text_len - 1;
+            }
+
+            /*
+             * Each output buffer has its own match table so that senders
+             * building frames at the same time don't share one.
+             */
+
+            chars = at_cmd_compress((uint8_t *)text, text_len, (uint8_t *)&rsp.buffer[rsp.len], limit,
+                                    g_cmd_parser.output[rsp.output_index].compress_hash);
+            if (chars > 0)
+            {
+                rsp.buffer[1] = AT_CMD_COMPRESSED_MSG_TYPE;
+                rsp.len      += chars;
+                text_len      = 0;
+            }
+        }
+#else
+        (void)compress;
+#endif
+
+        /*
+         * Add in the asynchronous host message text.
+         */
+
+        at_cmd_parser_response_append(&rsp, text, text_len);
+    }
+
+    return at_cmd_response_finish(&rsp);
+}
+
+
+/** Send a status response generated by the library.
+ *
+ * Unlike at_cmd_parser_send_cmd_response() the response doesn't release the in flight
+ * limit of a command with the same serial number that the application has yet to answer.
+ *
+ * @param[in] cmd_parser : Pointer to the main parser structure
+ * @param[in] serial     : Serial number of the response.
+ * @param[in] status     : Status value of the response.
+ * @param[in] text       : Optional response text.
+ *
+ * @return    Status of the operation.
+ */
+
+static cy_rslt_t at_cmd_send_status(at_cmd_parser_t *cmd_parser, uint32_t serial, uint32_t status, char *text)
+{
+    if (at_cmd_response_complete(cmd_parser, serial, status, text, NULL))
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    return at_cmd_send_host_message(false, false, serial, status, text);
+}
+
+
+cy_rslt_t at_cmd_parser_init(at_cmd_params_t *params)
+{
+    cy_rslt_t result;
+    int i;
+
+    if (params == NULL || params->cmd_msg_queue == NULL || params->write_data == NULL ||
+        (params->is_data_ready == NULL) != (params->read_data == NULL) || params->inline_msg_size > AT_CMD_MAX_INLINE_MSG_SIZE ||
+        (params->inline_msg_size > 0 && params->inline_msg_size < sizeof(at_cmd_msg_base_t)))
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    /*
+     * Copy over the parameters.
+     */
+
+    g_cmd_parser.msg_queue     = params->cmd_msg_queue;
+    g_cmd_parser.is_data_ready = params->is_data_ready;
+    g_cmd_parser.read_data     = params->read_data;
+    g_cmd_parser.write_data    = params->write_data;
+    g_cmd_parser.write_data_async = params->write_data_async;
+    g_cmd_parser.flow_control  = params->flow_control;
+    g_cmd_parser.opaque        = params->opaque;
+
+    g_cmd_parser.advertise_credits = params->advertise_credits;
+    g_cmd_parser.credits_advertised = UINT32_MAX;
+    g_cmd_parser.credits_pending    = UINT32_MAX;
+    cy_rtos_get_time(&g_cmd_parser.credits_time);
+    g_cmd_parser.credits_time -= AT_CMD_CREDITS_MIN_INTERVAL_MS;
+    g_cmd_parser.inline_msg_size   = params->inline_msg_size;
+
+    for (i = 0; i < AT_CMD_MAX_CMD_CLASSES; i++)
+    {
+        g_cmd_parser.class_msg_queue[i] = params->class_msg_queue[i];
+    }
+
+#if AT_CMD_LIMIT_ENTRIES > 0
+    /*
+     * Limits are updated with the table mutex held so the limit mutex is needed first.
+     */
+
+    result = cy_rtos_mutex_init(&g_cmd_parser.limit_mutex, false);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating limit mutex\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+#endif
+
+    /*
+     * Initialize the command table mutex.
+     */
+
+    result = cy_rtos_mutex_init(&g_cmd_parser.table_mutex, false);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating table mutex\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+    g_cmd_parser.table_mutex_ready = true;
+
+    /*
+     * Only one frame at a time can be handed to a synchronous transport so there
+     * is no point in building more than one.
+     */
+
+    g_cmd_parser.output_count = (params->write_data_async != NULL) ? AT_CMD_NUM_OUTPUT_BUFFERS : 1;
+    g_cmd_parser.output_free  = g_cmd_parser.output_count;
+
+    /*
+     * Initialize the output buffer mutex.
+     */
+
+    result = cy_rtos_mutex_init(&g_cmd_parser.output_mutex, true);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating output mutex\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    for (i = 0; i < AT_CMD_OUTPUT_CLASS_MAX; i++)
+    {
+        result = cy_rtos_semaphore_init(&g_cmd_parser.output_sem[i], AT_CMD_OUTPUT_MAX_WAITERS, 0);
+        if (result != CY_RSLT_SUCCESS)
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating output semaphore\n");
+            return CY_AT_CMD_PARSER_ERROR;
+        }
+    }
+
+#if AT_CMD_BATCH_MAX_ENTRIES > 0
+    result = cy_rtos_mutex_init(&g_cmd_parser.batch_mutex, false);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating batch mutex\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+#endif
+
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+    result = cy_rtos_mutex_init(&g_cmd_parser.retransmit_mutex, false);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating retransmit mutex\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+#endif
+
+    /*
+     * Set up the AT command prefix string for input scanning.
+     */
+
+    strcpy(g_cmd_parser.at_cmd_prefix, AT_CMD_PREFIX);
+
+    for (i = 0; i < AT_CMD_NUM_CHANNELS; i++)
+    {
+        at_cmd_reset_command_buffer(&g_cmd_parser.framer[i]);
+    }
+
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    at_cmd_diag_reset(&g_cmd_parser);
+#endif
+
+#if AT_CMD_ERROR_EVENTS > 0
+    /*
+     * Framing errors are sent from their own thread so the input thread never waits for the output.
+     */
+
+    if (cy_rtos_mutex_init(&g_cmd_parser.error_mutex, false) != CY_RSLT_SUCCESS ||
+        cy_rtos_semaphore_init(&g_cmd_parser.error_sem, 1, 0) != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating error event resources\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    result = cy_rtos_create_thread(&g_cmd_parser.error_thread, at_cmd_error_thread_func, "AT Error Thread", NULL,
+                                   AT_CMD_ERROR_STACK_SIZE, CY_RTOS_PRIORITY_NORMAL, (cy_thread_arg_t)&g_cmd_parser);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating error thread\n");
+        return result;
+    }
+#endif
+
+#if AT_CMD_NUM_WORKERS > 0
+    /*
+     * Set up the worker threads and the jobs they share.
+     */
+
+    if (cy_rtos_mutex_init(&g_cmd_parser.job_mutex, false) != CY_RSLT_SUCCESS ||
+        cy_rtos_semaphore_init(&g_cmd_parser.job_free_sem, AT_CMD_WORKER_JOBS, AT_CMD_WORKER_JOBS) != CY_RSLT_SUCCESS ||
+        cy_rtos_queue_init(&g_cmd_parser.job_queue, AT_CMD_WORKER_JOBS, sizeof(uint32_t)) != CY_RSLT_SUCCESS)
+    {
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating worker resources\n");
+        return CY_AT_CMD_PARSER_ERROR;
+    }
+
+    for (i = 0; i < AT_CMD_NUM_WORKERS; i++)
+    {
+        result = cy_rtos_create_thread(&g_cmd_parser.worker_thread[i], at_cmd_worker_thread_func, "AT Worker Thread", NULL,
+                                       AT_CMD_WORKER_STACK_SIZE, CY_RTOS_PRIORITY_NORMAL, (cy_thread_arg_t)&g_cmd_parser);
+        if (result != CY_RSLT_SUCCESS)
+        {
+            at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating worker thread\n");
+            return result;
+        }
+    }
+#endif
+
+    /*
+     * Spawn off our input thread. Without read functions the application
+     * pushes input to us with at_cmd_parser_input() instead.
+     */
+
+    if (g_cmd_parser.read_data == NULL)
+    {
+        return CY_RSLT_SUCCESS;
     }
 
+    result = cy_rtos_create_thread(&g_cmd_parser.input_thread, at_cmd_input_thread_func, "Input Thread", NULL,
+                                    INPUT_THREAD_STACK_SIZE, CY_RTOS_PRIORITY_NORMAL, (cy_thread_arg_t)&g_cmd_parser);
+
     return result;
 }
 
 
-static void at_cmd_input_thread_func(cy_thread_arg_t arg)
+/** Run a change to the command tables.
+ *
+ * Tables registered before at_cmd_parser_init() is called are added without
+ * locking since there are no other threads using the parser yet.
+ */
+
+static cy_rslt_t at_cmd_tables_change(at_cmd_def_t *old_table, at_cmd_def_t *new_table, uint32_t num_cmds)
 {
-    at_cmd_parser_t *cmd_parser = (at_cmd_parser_t *)arg;
-    uint32_t count;
-    uint8_t buffer[INPUT_BUFFER_SIZE];
+    cy_rslt_t result;
 
-    at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_DEBUG, "AT CMD: Input thread starting\n");
-    while (1)
+    if (g_cmd_parser.table_mutex_ready)
     {
-        /* Check if host sent any data */
-        if (cmd_parser->is_data_ready(cmd_parser->opaque))
-        {
-            /* Get number of bytes */
-            count = cmd_parser->read_data(buffer, INPUT_BUFFER_SIZE, cmd_parser->opaque);
-            if (0 != count)
-            {
-                at_cmd_add_command_chars(cmd_parser, buffer, count);
-            }
-        }
-        else
-        {
-            /*
-             * No data waiting. Sleep for a bit before checking again.
-             */
+        cy_rtos_mutex_get(&g_cmd_parser.table_mutex, CY_RTOS_NEVER_TIMEOUT);
+    }
 
-            cy_rtos_delay_milliseconds(1);
-        }
+    result = at_cmd_tables_update(&g_cmd_parser, old_table, new_table, num_cmds);
+
+    if (g_cmd_parser.table_mutex_ready)
+    {
+        cy_rtos_mutex_set(&g_cmd_parser.table_mutex);
     }
+
+    return result;
 }
 
 
-static cy_rslt_t at_cmd_send_host_message(bool async_msg, uint32_t serial, uint32_t status, char *text)
+uint32_t at_cmd_parser_input(uint8_t *data, uint32_t len)
 {
-    cy_rslt_t result;
-    uint32_t buflen = AT_CMD_PARSER_BUFFER_SIZE;
-    uint32_t data_bytes;
-    char *data;
-    char *size;
-    char *ptr;
-    int chars;
-    int i;
+    if (data == NULL || len == 0 || g_cmd_parser.read_data != NULL)
+    {
+        return 0;
+    }
 
     /*
-     * Grab the mutex to make sure no one else is using the output buffer.
+     * Leave the data with the caller while the application has no room for more commands.
      */
 
-    result = cy_rtos_mutex_get(&g_cmd_parser.output_mutex, CY_RTOS_NEVER_TIMEOUT);
-    if (result != CY_RSLT_SUCCESS)
+    if (at_cmd_check_flow_control(&g_cmd_parser))
     {
-        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error getting output mutex\n");
-        return CY_AT_CMD_PARSER_ERROR;
+        return 0;
     }
 
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    atomic_fetch_add_explicit(&g_cmd_parser.diag.rx_bytes, len, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_cmd_parser.diag.rx_reads, 1, memory_order_relaxed);
+#endif
+
+    at_cmd_add_command_chars(&g_cmd_parser, &g_cmd_parser.framer[0], data, len);
+
     /*
-     * We need to construct the proper message header.
+     * Tell the transport and the host about the entries this input used up.
      */
 
-    ptr = (char *)g_cmd_parser.output_buffer;
-    *ptr++ = '+';
+    at_cmd_check_flow_control(&g_cmd_parser);
 
-    if (async_msg)
-    {
-        /*
-         * Asynchronous host message.
-         */
+    return len;
+}
 
-        *ptr++ = 'H';
-    }
-    else
+
+cy_rslt_t at_cmd_parser_register_commands(at_cmd_def_t *cmd_table, uint32_t num_cmds)
+{
+    if (cmd_table == NULL || num_cmds == 0)
     {
-        /*
-         * Status message.
-         */
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    return at_cmd_tables_change(NULL, cmd_table, num_cmds);
+}
 
-        *ptr++ = 'S';
+
+cy_rslt_t at_cmd_parser_unregister_commands(at_cmd_def_t *cmd_table)
+{
+    if (cmd_table == NULL)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
     }
 
-    /*
-     * Allow 4 digits for the message size.
-     */
+    return at_cmd_tables_change(cmd_table, NULL, 0);
+}
 
-    size = ptr;
-    for (i = 0; i < AT_CMD_SIZE_CHARS; i++)
+
+cy_rslt_t at_cmd_parser_swap_commands(at_cmd_def_t *old_table, at_cmd_def_t *new_table, uint32_t num_cmds)
+{
+    if (old_table == NULL || new_table == NULL || num_cmds == 0)
     {
-        *ptr++ = '0';
+        return CY_AT_CMD_PARSER_BAD_PARAM;
     }
 
-    /*
-     * Add in the serial number.
-     */
+    return at_cmd_tables_change(old_table, new_table, num_cmds);
+}
 
-    *ptr++ = ',';
-    chars = snprintf(ptr, buflen - (uint32_t)((uint32_t)ptr - (uint32_t)g_cmd_parser.output_buffer), "%" PRIu32, serial);
-    ptr += chars;
+cy_rslt_t at_cmd_parser_send_cmd_response(uint32_t serial, uint32_t status, char *text)
+{
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_release(&g_cmd_parser, serial, NULL);
+#endif
 
-    *ptr++ = ';';
-    data   = ptr;
+    return at_cmd_send_status(&g_cmd_parser, serial, status, text);
+}
 
-    if (!async_msg)
+cy_rslt_t at_cmd_parser_send_cmd_async_response(uint32_t serial, char *text)
+{
+    return at_cmd_send_host_message(true, false, serial, 0, text);
+}
+
+cy_rslt_t at_cmd_parser_send_cmd_async_response_compressed(uint32_t serial, char *text)
+{
+    return at_cmd_send_host_message(true, true, serial, 0, text);
+}
+
+cy_rslt_t at_cmd_parser_enable_async_compression(bool enable)
+{
+#ifdef ENABLE_AT_CMD_COMPRESSION
+    g_cmd_parser.compress_async = enable;
+    return CY_RSLT_SUCCESS;
+#else
+    (void)enable;
+    return CY_AT_CMD_PARSER_UNSUPPORTED;
+#endif
+}
+
+cy_rslt_t at_cmd_parser_set_output_bandwidth(at_cmd_output_class_t output_class, uint32_t bytes_per_sec)
+{
+    at_cmd_output_rate_t *rate;
+
+    if (output_class >= AT_CMD_OUTPUT_CLASS_MAX)
     {
-        /*
-         * Add in the status value.
-         */
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
+
+    if (cy_rtos_mutex_get(&g_cmd_parser.output_mutex, CY_RTOS_NEVER_TIMEOUT) != CY_RSLT_SUCCESS)
+    {
+        return CY_AT_CMD_PARSER_ERROR;
+    }
 
-        chars = snprintf(ptr, buflen - (uint32_t)((uint32_t)ptr - (uint32_t)g_cmd_parser.output_buffer), "%" PRIu32, status);
-        ptr += chars;
+    rate = &g_cmd_parser.output_rate[output_class];
+    rate->bytes_per_sec = bytes_per_sec;
+    rate->tokens        = 0;
+    cy_rtos_get_time(&rate->last_refill);
 
-        /*
-         * And any optional message text.
-         */
+    cy_rtos_mutex_set(&g_cmd_parser.output_mutex);
+
+    return CY_RSLT_SUCCESS;
+}
 
-        if (text != NULL && text[0] != '\0')
+cy_rslt_t at_cmd_parser_write_complete(cy_rslt_t result)
+{
+    at_cmd_output_buffer_t *output = NULL;
+    uint32_t i;
+
+    cy_rtos_mutex_get(&g_cmd_parser.output_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    for (i = 0; g_cmd_parser.output_sending && i < g_cmd_parser.output_count; i++)
+    {
+        if (g_cmd_parser.output[i].state == AT_CMD_OUTPUT_SENDING)
         {
-            chars = snprintf(ptr, buflen - (uint32_t)((uint32_t)ptr - (uint32_t)g_cmd_parser.output_buffer), ",%s", text);
-            ptr += chars;
+            output = &g_cmd_parser.output[i];
+            break;
         }
     }
-    else
-    {
-        /*
-         * Add in the asynchronous host message text.
-         */
 
-        chars = snprintf(ptr, buflen - (uint32_t)((uint32_t)ptr - (uint32_t)g_cmd_parser.output_buffer), "%s", text);
-        ptr += chars;
+    if (output == NULL)
+    {
+        cy_rtos_mutex_set(&g_cmd_parser.output_mutex);
+        return CY_AT_CMD_PARSER_ERROR;
     }
 
-    /*
-     * Add in the data size and the trailing ';'
-     */
-
-    data_bytes = (uint32_t)((uint32_t)ptr - (uint32_t)data);
-    size += AT_CMD_SIZE_CHARS - 1;
-    for (i = 0; i < AT_CMD_SIZE_CHARS; i++)
+    if (result != CY_RSLT_SUCCESS)
     {
-        *size-- = (data_bytes % 10) + '0';
-        data_bytes /= 10;
+        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: output write failed\n");
     }
 
-    *ptr++ = ';';
-    *ptr++ = '\r';
-    *ptr++ = '\n';
-    *ptr   = '\0';
+    g_cmd_parser.output_sending = false;
+    at_cmd_output_release(&g_cmd_parser, i, output->len);
+    at_cmd_output_start_next(&g_cmd_parser);
 
-    /*
-     * Send the message off to the external host.
-     */
+    cy_rtos_mutex_set(&g_cmd_parser.output_mutex);
 
-    result = g_cmd_parser.write_data(g_cmd_parser.output_buffer, (uint32_t)((uint32_t)ptr - (uint32_t)g_cmd_parser.output_buffer), g_cmd_parser.opaque);
+    return CY_RSLT_SUCCESS;
+}
 
-    /*
-     * Release the mutex.
-     */
+cy_rslt_t at_cmd_parser_get_credits(uint32_t *credits)
+{
+    if (credits == NULL || g_cmd_parser.msg_queue == NULL)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
 
-    cy_rtos_mutex_set(&g_cmd_parser.output_mutex);
+    *credits = at_cmd_queue_credits(&g_cmd_parser);
 
-    return result;
+    return CY_RSLT_SUCCESS;
 }
 
-
-cy_rslt_t at_cmd_parser_init(at_cmd_params_t *params)
+bool at_cmd_parser_check_deadline(at_cmd_msg_base_t *msg)
 {
-    cy_rslt_t result;
+    if (msg == NULL || !at_cmd_deadline_expired(msg))
+    {
+        return false;
+    }
+
+    at_cmd_parser_send_cmd_response(msg->serial, AT_CMD_STATUS_TIMEOUT, "Deadline expired");
+
+    return true;
+}
 
-    if (params == NULL || params->cmd_msg_queue == NULL || params->is_data_ready == NULL ||
-        params->read_data == NULL || params->write_data == NULL)
+at_cmd_msg_base_t *at_cmd_parser_get_msg(at_cmd_msg_queue_t *entry)
+{
+    if (entry == NULL)
     {
-        return CY_AT_CMD_PARSER_BAD_PARAM;
+        return NULL;
     }
 
     /*
-     * Copy over the parameters.
+     * An inline message follows the entry.
      */
 
-    g_cmd_parser.msg_queue     = params->cmd_msg_queue;
-    g_cmd_parser.is_data_ready = params->is_data_ready;
-    g_cmd_parser.read_data     = params->read_data;
-    g_cmd_parser.write_data    = params->write_data;
-    g_cmd_parser.opaque        = params->opaque;
+    return (entry->msg != NULL) ? entry->msg : (at_cmd_msg_base_t *)(entry + 1);
+}
 
-    /*
-     * Initialize the output buffer mutex.
-     */
+void at_cmd_parser_free_msg(at_cmd_msg_queue_t *entry)
+{
+    if (entry != NULL && entry->msg != NULL)
+    {
+        free(entry->msg);
+        entry->msg = NULL;
+    }
+}
 
-    result = cy_rtos_mutex_init(&g_cmd_parser.output_mutex, true);
-    if (result != CY_RSLT_SUCCESS)
+cy_rslt_t at_cmd_parser_get_retransmit_stats(at_cmd_retransmit_stats_t *stats)
+{
+#if AT_CMD_RETRANSMIT_CACHE_ENTRIES > 0
+    if (stats == NULL)
     {
-        at_cy_log_msg(CYLF_MIDDLEWARE, CY_LOG_ERR, "AT CMD: Error creating output mutex\n");
-        return CY_AT_CMD_PARSER_ERROR;
+        return CY_AT_CMD_PARSER_BAD_PARAM;
     }
 
-    /*
-     * Set up the AT command prefix string for input scanning.
-     */
+    cy_rtos_mutex_get(&g_cmd_parser.retransmit_mutex, CY_RTOS_NEVER_TIMEOUT);
+    *stats = g_cmd_parser.retransmit_stats;
+    cy_rtos_mutex_set(&g_cmd_parser.retransmit_mutex);
 
-    strcpy(g_cmd_parser.at_cmd_prefix, AT_CMD_PREFIX);
+    return CY_RSLT_SUCCESS;
+#else
+    (void)stats;
+    return CY_AT_CMD_PARSER_UNSUPPORTED;
+#endif
+}
 
-    /*
-     * Spawn off our input thread.
-     */
+cy_rslt_t at_cmd_parser_get_limit_stats(const at_cmd_limits_t *limits, at_cmd_limit_stats_t *stats)
+{
+#if AT_CMD_LIMIT_ENTRIES > 0
+    at_cmd_limit_state_t *state;
 
-    result = cy_rtos_create_thread(&g_cmd_parser.input_thread, at_cmd_input_thread_func, "Input Thread", NULL,
-                                    INPUT_THREAD_STACK_SIZE, CY_RTOS_PRIORITY_NORMAL, (cy_thread_arg_t)&g_cmd_parser);
+    if (limits == NULL || stats == NULL)
+    {
+        return CY_AT_CMD_PARSER_BAD_PARAM;
+    }
 
-    return result;
+    cy_rtos_mutex_get(&g_cmd_parser.limit_mutex, CY_RTOS_NEVER_TIMEOUT);
+    state = at_cmd_limit_find_state(&g_cmd_parser, limits);
+    if (state != NULL)
+    {
+        stats->in_flight = state->in_flight;
+        stats->rejected  = state->rejected;
+    }
+    cy_rtos_mutex_set(&g_cmd_parser.limit_mutex);
+
+    return (state != NULL) ? CY_RSLT_SUCCESS : CY_AT_CMD_PARSER_BAD_PARAM;
+#else
+    (void)limits;
+    (void)stats;
+    return CY_AT_CMD_PARSER_UNSUPPORTED;
+#endif
 }
 
+cy_rslt_t at_cmd_parser_register_diag_commands(void)
+{
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    return at_cmd_parser_register_commands(g_at_cmd_diag_table, AT_CMD_DIAG_NUM_CMDS);
+#else
+    return CY_AT_CMD_PARSER_UNSUPPORTED;
+#endif
+}
 
-cy_rslt_t at_cmd_parser_register_commands(at_cmd_def_t *cmd_table, uint32_t num_cmds)
+cy_rslt_t at_cmd_parser_unregister_diag_commands(void)
 {
-    at_cmd_table_t *cmd_table_node;
-    at_cmd_table_t *ptr;
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    return at_cmd_parser_unregister_commands(g_at_cmd_diag_table);
+#else
+    return CY_AT_CMD_PARSER_UNSUPPORTED;
+#endif
+}
 
-    if (cmd_table == NULL || num_cmds == 0)
+cy_rslt_t at_cmd_parser_get_diag_stats(at_cmd_diag_stats_t *stats)
+{
+#ifdef ENABLE_AT_CMD_DIAGNOSTICS
+    if (stats == NULL)
     {
         return CY_AT_CMD_PARSER_BAD_PARAM;
     }
 
-    /*
-     * Allocate a new command table node.
-     */
+    at_cmd_diag_read(&g_cmd_parser, stats);
+
+    return CY_RSLT_SUCCESS;
+#else
+    (void)stats;
+    return CY_AT_CMD_PARSER_UNSUPPORTED;
+#endif
+}
 
-    cmd_table_node = calloc(1, sizeof(at_cmd_table_t));
-    if (cmd_table_node == NULL)
+cy_rslt_t at_cmd_parser_get_footprint(at_cmd_footprint_t *footprint)
+{
+    if (footprint == NULL)
     {
-        return CY_AT_CMD_PARSER_NO_MEMORY;
+        return CY_AT_CMD_PARSER_BAD_PARAM;
     }
 
-    cmd_table_node->cmd_table = cmd_table;
-    cmd_table_node->num_cmds  = num_cmds;
+    footprint->profile       = AT_CMD_PROFILE;
+    footprint->static_ram    = sizeof(g_cmd_parser);
+    footprint->buffer_size   = AT_CMD_PARSER_BUFFER_SIZE;
+    footprint->max_cmd_size  = AT_CMD_MAX_SIZE;
+    footprint->thread_stacks = (g_cmd_parser.read_data != NULL) ? INPUT_THREAD_STACK_SIZE : 0;
+#if AT_CMD_NUM_WORKERS > 0
+    footprint->thread_stacks += AT_CMD_NUM_WORKERS * AT_CMD_WORKER_STACK_SIZE;
+#endif
+#if AT_CMD_ERROR_EVENTS > 0
+    footprint->thread_stacks += AT_CMD_ERROR_STACK_SIZE;
+#endif
 
-    /*
-     * Add the command table node to our list.
-     */
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t at_cmd_parser_response_begin(at_cmd_response_t *rsp, uint32_t serial, uint32_t status)
+{
+    cy_rslt_t result;
 
-    if (g_cmd_parser.cmd_tables == NULL)
+    result = at_cmd_response_start(rsp, AT_CMD_STATUS_MSG_TYPE, serial);
+    if (result == CY_RSLT_SUCCESS)
     {
-        g_cmd_parser.cmd_tables = cmd_table_node;
+        rsp->len        += at_cmd_format_uint(&rsp->buffer[rsp->len], status);
+        rsp->sep_pending = true;
+        rsp->serial      = serial;
+        rsp->status      = status;
+        rsp->status_end  = rsp->len;
     }
-    else
+
+    return result;
+}
+
+cy_rslt_t at_cmd_parser_async_response_begin(at_cmd_response_t *rsp, uint32_t serial, const char *msg_name)
+{
+    cy_rslt_t result;
+
+    if (msg_name == NULL)
     {
-        for (ptr = g_cmd_parser.cmd_tables; ptr->next != NULL; ptr = ptr->next)
-            ;
-        ptr->next = cmd_table_node;
+        return CY_AT_CMD_PARSER_BAD_PARAM;
     }
 
-    return CY_RSLT_SUCCESS;
+    result = at_cmd_response_start(rsp, AT_CMD_ASYNC_MSG_TYPE, serial);
+    if (result == CY_RSLT_SUCCESS)
+    {
+        at_cmd_parser_response_append(rsp, msg_name, strlen(msg_name));
+        rsp->sep_pending = true;
+    }
+
+    return result;
 }
 
-cy_rslt_t at_cmd_parser_send_cmd_response(uint32_t serial, uint32_t status, char *text)
+cy_rslt_t at_cmd_parser_response_send(at_cmd_response_t *rsp)
 {
-    return at_cmd_send_host_message(false, serial, status, text);
+    char *text;
+
+    if (rsp != NULL && rsp->buffer != NULL && rsp->output_class == AT_CMD_OUTPUT_CLASS_STATUS &&
+        !rsp->overflow && rsp->len - rsp->data_start <= AT_CMD_MAX_SIZE)
+    {
+        /*
+         * The response text is terminated in the space reserved for the trailer
+         * so it can be recorded like the text of any other response.
+         */
+
+        rsp->buffer[rsp->len] = '\0';
+        text = (rsp->len > rsp->status_end) ? &rsp->buffer[rsp->status_end + 1] : &rsp->buffer[rsp->len];
+#if AT_CMD_LIMIT_ENTRIES > 0
+        at_cmd_limit_release(&g_cmd_parser, rsp->serial, NULL);
+#endif
+        if (at_cmd_response_complete(&g_cmd_parser, rsp->serial, rsp->status, text, rsp))
+        {
+            return CY_RSLT_SUCCESS;
+        }
+    }
+
+    return at_cmd_response_finish(rsp);
 }
 
-cy_rslt_t at_cmd_parser_send_cmd_async_response(uint32_t serial, char *text)
+void at_cmd_parser_response_cancel(at_cmd_response_t *rsp)
 {
-    return at_cmd_send_host_message(true, serial, 0, text);
+    at_cmd_response_abort(rsp);
 }
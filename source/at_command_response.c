@@ -0,0 +1,353 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+* @file at_command_response.c
+* @brief Response builder and JSON writer for the AT Command Parser Library.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cy_result.h"
+#include "cyabs_rtos.h"
+
+#include "at_command_parser.h"
+#include "at_command_parser_private.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define AT_CMD_UINT32_MAX_DIGITS        (10)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static const char at_cmd_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char at_cmd_hex_digits[] = "0123456789abcdef";
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+uint32_t at_cmd_format_uint(char *buf, uint32_t value)
+{
+    char digits[AT_CMD_UINT32_MAX_DIGITS];
+    char *ptr = &digits[AT_CMD_UINT32_MAX_DIGITS];
+    uint32_t pair;
+    uint32_t len;
+
+    /*
+     * Work from the least significant end two digits at a time.
+     */
+
+    while (value >= 100)
+    {
+        pair   = (value % 100) * 2;
+        value /= 100;
+        *--ptr = at_cmd_digit_pairs[pair + 1];
+        *--ptr = at_cmd_digit_pairs[pair];
+    }
+
+    if (value >= 10)
+    {
+        pair   = value * 2;
+        *--ptr = at_cmd_digit_pairs[pair + 1];
+        *--ptr = at_cmd_digit_pairs[pair];
+    }
+    else
+    {
+        *--ptr = (char)('0' + value);
+    }
+
+    len = (uint32_t)(&digits[AT_CMD_UINT32_MAX_DIGITS] - ptr);
+    memcpy(buf, ptr, len);
+
+    return len;
+}
+
+
+/** Reserve space in the output frame.
+ *
+ * Emits the pending text separator first if needed.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ * @param[in] len : Number of bytes needed.
+ *
+ * @return Pointer to write to or NULL if the frame is full.
+ */
+
+static char *at_cmd_response_reserve(at_cmd_response_t *rsp, uint32_t len)
+{
+    char *ptr;
+
+    if (rsp == NULL || rsp->buffer == NULL || rsp->overflow)
+    {
+        return NULL;
+    }
+
+    if (rsp->len + len + (rsp->sep_pending ? 1 : 0) > rsp->size)
+    {
+        rsp->overflow = true;
+        return NULL;
+    }
+
+    if (rsp->sep_pending)
+    {
+        rsp->buffer[rsp->len++] = ',';
+        rsp->sep_pending = false;
+    }
+
+    ptr = &rsp->buffer[rsp->len];
+    rsp->len += len;
+
+    return ptr;
+}
+
+
+void at_cmd_parser_response_append(at_cmd_response_t *rsp, const char *text, uint32_t len)
+{
+    char *ptr;
+
+    if (text == NULL || len == 0)
+    {
+        return;
+    }
+
+    if ((ptr = at_cmd_response_reserve(rsp, len)) != NULL)
+    {
+        memcpy(ptr, text, len);
+    }
+}
+
+
+/** Append a JSON string with escaping.
+ *
+ * @param[in] rsp   : Pointer to the response builder.
+ * @param[in] value : Nul terminated string.
+ */
+
+static void at_cmd_json_put_string(at_cmd_response_t *rsp, const char *value)
+{
+    const char *run;
+    char escape[6];
+    uint8_t c;
+
+    at_cmd_parser_response_append(rsp, "\"", 1);
+
+    /*
+     * Copy runs of characters that don't need escaping in one go.
+     */
+
+    for (run = value; *value != '\0'; value++)
+    {
+        c = (uint8_t)*value;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+
+        at_cmd_parser_response_append(rsp, run, (uint32_t)(value - run));
+        run = value + 1;
+
+        escape[0] = '\\';
+        switch (c)
+        {
+            case '"':
+            case '\\':
+                escape[1] = (char)c;
+                at_cmd_parser_response_append(rsp, escape, 2);
+                break;
+
+            case '\n':
+                at_cmd_parser_response_append(rsp, "\\n", 2);
+                break;
+
+            case '\r':
+                at_cmd_parser_response_append(rsp, "\\r", 2);
+                break;
+
+            case '\t':
+                at_cmd_parser_response_append(rsp, "\\t", 2);
+                break;
+
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = at_cmd_hex_digits[c >> 4];
+                escape[5] = at_cmd_hex_digits[c & 0x0F];
+                at_cmd_parser_response_append(rsp, escape, 6);
+                break;
+        }
+    }
+
+    at_cmd_parser_response_append(rsp, run, (uint32_t)(value - run));
+    at_cmd_parser_response_append(rsp, "\"", 1);
+}
+
+
+/** Start a JSON value, emitting the separator and member name as needed.
+ *
+ * @param[in] rsp : Pointer to the response builder.
+ * @param[in] key : Member name or NULL.
+ */
+
+static void at_cmd_json_put_key(at_cmd_response_t *rsp, const char *key)
+{
+    if (rsp == NULL)
+    {
+        return;
+    }
+
+    if (rsp->need_comma)
+    {
+        at_cmd_parser_response_append(rsp, ",", 1);
+    }
+
+    if (key != NULL)
+    {
+        at_cmd_json_put_string(rsp, key);
+        at_cmd_parser_response_append(rsp, ":", 1);
+    }
+
+    rsp->need_comma = true;
+}
+
+
+void at_cmd_parser_json_object_begin(at_cmd_response_t *rsp, const char *key)
+{
+    at_cmd_json_put_key(rsp, key);
+    at_cmd_parser_response_append(rsp, "{", 1);
+    if (rsp != NULL)
+    {
+        rsp->need_comma = false;
+    }
+}
+
+
+void at_cmd_parser_json_object_end(at_cmd_response_t *rsp)
+{
+    at_cmd_parser_response_append(rsp, "}", 1);
+    if (rsp != NULL)
+    {
+        rsp->need_comma = true;
+    }
+}
+
+
+void at_cmd_parser_json_array_begin(at_cmd_response_t *rsp, const char *key)
+{
+    at_cmd_json_put_key(rsp, key);
+    at_cmd_parser_response_append(rsp, "[", 1);
+    if (rsp != NULL)
+    {
+        rsp->need_comma = false;
+    }
+}
+
+
+void at_cmd_parser_json_array_end(at_cmd_response_t *rsp)
+{
+    at_cmd_parser_response_append(rsp, "]", 1);
+    if (rsp != NULL)
+    {
+        rsp->need_comma = true;
+    }
+}
+
+
+void at_cmd_parser_json_add_string(at_cmd_response_t *rsp, const char *key, const char *value)
+{
+    at_cmd_json_put_key(rsp, key);
+    at_cmd_json_put_string(rsp, (value != NULL) ? value : "");
+}
+
+
+void at_cmd_parser_json_add_uint(at_cmd_response_t *rsp, const char *key, uint32_t value)
+{
+    char *ptr;
+
+    at_cmd_json_put_key(rsp, key);
+    if ((ptr = at_cmd_response_reserve(rsp, AT_CMD_UINT32_MAX_DIGITS)) != NULL)
+    {
+        rsp->len -= AT_CMD_UINT32_MAX_DIGITS - at_cmd_format_uint(ptr, value);
+    }
+}
+
+
+void at_cmd_parser_json_add_int(at_cmd_response_t *rsp, const char *key, int32_t value)
+{
+    char *ptr;
+
+    at_cmd_json_put_key(rsp, key);
+    if ((ptr = at_cmd_response_reserve(rsp, AT_CMD_UINT32_MAX_DIGITS + 1)) != NULL)
+    {
+        if (value < 0)
+        {
+            *ptr = '-';
+            rsp->len -= AT_CMD_UINT32_MAX_DIGITS - at_cmd_format_uint(ptr + 1, (uint32_t)0 - (uint32_t)value);
+        }
+        else
+        {
+            rsp->len -= AT_CMD_UINT32_MAX_DIGITS + 1 - at_cmd_format_uint(ptr, (uint32_t)value);
+        }
+    }
+}
+
+
+void at_cmd_parser_json_add_bool(at_cmd_response_t *rsp, const char *key, bool value)
+{
+    at_cmd_json_put_key(rsp, key);
+    if (value)
+    {
+        at_cmd_parser_response_append(rsp, "true", 4);
+    }
+    else
+    {
+        at_cmd_parser_response_append(rsp, "false", 5);
+    }
+}
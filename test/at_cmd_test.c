@@ -0,0 +1,260 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file at_cmd_test.c
+ * @brief Helpers shared by the host tests of the AT Command Parser library
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static uint32_t g_checks;
+static uint32_t g_failures;
+
+static cy_queue_t g_msg_queue;
+static uint32_t g_inline_msg_size;
+
+static pthread_mutex_t g_output_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char g_output[AT_CMD_TEST_OUTPUT_SIZE + 1];
+static uint32_t g_output_len;
+
+static atomic_bool g_output_block;
+static atomic_bool g_output_waiting;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static cy_rslt_t at_cmd_test_write(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    (void)opaque;
+
+    /*
+     * Hold the writer while the output is blocked, like a transport the host has flowed off.
+     */
+
+    while (atomic_load(&g_output_block))
+    {
+        atomic_store(&g_output_waiting, true);
+        usleep(1000);
+    }
+    atomic_store(&g_output_waiting, false);
+
+    pthread_mutex_lock(&g_output_mutex);
+    if (length > AT_CMD_TEST_OUTPUT_SIZE - g_output_len)
+    {
+        length = AT_CMD_TEST_OUTPUT_SIZE - g_output_len;
+    }
+    memcpy(&g_output[g_output_len], buffer, length);
+    g_output_len += length;
+    g_output[g_output_len] = '\0';
+    pthread_mutex_unlock(&g_output_mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+void at_cmd_test_check(bool ok, const char *expr, const char *file, int line)
+{
+    g_checks++;
+    if (!ok)
+    {
+        g_failures++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    }
+}
+
+int at_cmd_test_finish(void)
+{
+    printf("%lu checks, %lu failed\n", (unsigned long)g_checks, (unsigned long)g_failures);
+
+    return (g_failures == 0) ? 0 : 1;
+}
+
+cy_rslt_t at_cmd_test_init(at_cmd_params_t *params, uint32_t queue_len)
+{
+    at_cmd_params_t defaults;
+    cy_rslt_t result;
+
+    if (params == NULL)
+    {
+        memset(&defaults, 0, sizeof(defaults));
+        params = &defaults;
+    }
+
+    g_inline_msg_size = params->inline_msg_size;
+    if (cy_rtos_queue_init(&g_msg_queue, queue_len, AT_CMD_MSG_QUEUE_ENTRY_SIZE(g_inline_msg_size)) != CY_RSLT_SUCCESS)
+    {
+        return CY_AT_CMD_PARSER_NO_MEMORY;
+    }
+
+    params->cmd_msg_queue = &g_msg_queue;
+    params->is_data_ready = NULL;
+    params->read_data     = NULL;
+    params->write_data    = at_cmd_test_write;
+
+    result = at_cmd_parser_init(params);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        cy_rtos_queue_deinit(&g_msg_queue);
+    }
+
+    return result;
+}
+
+uint32_t at_cmd_test_input(const void *data, uint32_t len)
+{
+    return at_cmd_parser_input((uint8_t *)data, len);
+}
+
+const char *at_cmd_test_output(void)
+{
+    return g_output;
+}
+
+uint32_t at_cmd_test_output_len(void)
+{
+    uint32_t len;
+
+    pthread_mutex_lock(&g_output_mutex);
+    len = g_output_len;
+    pthread_mutex_unlock(&g_output_mutex);
+
+    return len;
+}
+
+uint32_t at_cmd_test_output_count(const char *str)
+{
+    const char *ptr;
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&g_output_mutex);
+    for (ptr = strstr(g_output, str); ptr != NULL; ptr = strstr(ptr + 1, str))
+    {
+        count++;
+    }
+    pthread_mutex_unlock(&g_output_mutex);
+
+    return count;
+}
+
+void at_cmd_test_block_output(bool block)
+{
+    atomic_store(&g_output_block, block);
+}
+
+bool at_cmd_test_output_waiting(void)
+{
+    return atomic_load(&g_output_waiting);
+}
+
+void at_cmd_test_clear_output(void)
+{
+    pthread_mutex_lock(&g_output_mutex);
+    g_output_len = 0;
+    g_output[0]  = '\0';
+    pthread_mutex_unlock(&g_output_mutex);
+}
+
+at_cmd_msg_base_t *at_cmd_test_get_msg(uint32_t timeout_ms)
+{
+    uint8_t entry[AT_CMD_MSG_QUEUE_ENTRY_SIZE(AT_CMD_MAX_INLINE_MSG_SIZE)];
+    at_cmd_msg_queue_t *msg_entry = (at_cmd_msg_queue_t *)entry;
+    at_cmd_msg_base_t *msg;
+
+    if (cy_rtos_queue_get(&g_msg_queue, entry, timeout_ms) != CY_RSLT_SUCCESS)
+    {
+        return NULL;
+    }
+
+    if (msg_entry->msg != NULL)
+    {
+        return msg_entry->msg;
+    }
+
+    msg = malloc(g_inline_msg_size);
+    if (msg != NULL)
+    {
+        memcpy(msg, at_cmd_parser_get_msg(msg_entry), g_inline_msg_size);
+    }
+
+    return msg;
+}
+
+uint32_t at_cmd_test_drain(void)
+{
+    at_cmd_msg_base_t *msg;
+    uint32_t count = 0;
+
+    while ((msg = at_cmd_test_get_msg(0)) != NULL)
+    {
+        free(msg);
+        count++;
+    }
+
+    return count;
+}
+
+at_cmd_msg_base_t *at_cmd_test_cmd_parser(uint32_t cmd_id, uint32_t serial, uint32_t cmd_args_len, uint8_t *cmd_args)
+{
+    at_cmd_test_msg_t *msg;
+
+    msg = calloc(1, sizeof(at_cmd_test_msg_t));
+    if (msg == NULL)
+    {
+        return NULL;
+    }
+
+    msg->base.cmd_id = cmd_id;
+    msg->base.serial = serial;
+    msg->len         = (cmd_args_len < AT_CMD_TEST_MAX_ARGS) ? cmd_args_len : AT_CMD_TEST_MAX_ARGS - 1;
+    memcpy(msg->args, cmd_args, msg->len);
+
+    return &msg->base;
+}
+
+at_cmd_msg_base_t *at_cmd_test_binary_parser(uint32_t cmd_id, uint32_t serial, uint8_t *data, uint32_t data_len)
+{
+    return at_cmd_test_cmd_parser(cmd_id, serial, data_len, data);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file at_cmd_test.h
+ * @brief Helpers shared by the host tests of the AT Command Parser library
+ *
+ * The library is initialized without an input thread. Tests pass input with
+ * at_cmd_test_input() and it is parsed before the call returns, so the output
+ * and the queued messages can be checked straight away.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "at_command_parser.h"
+
+/******************************************************
+ *                     Macros
+ ******************************************************/
+
+#define AT_CMD_TEST_CHECK(cond)             at_cmd_test_check((cond), #cond, __FILE__, __LINE__)
+
+#define AT_CMD_TEST_INPUT(str)              at_cmd_test_input((str), sizeof(str) - 1)
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define AT_CMD_TEST_OUTPUT_SIZE             (1024 * 1024)
+#define AT_CMD_TEST_MAX_ARGS                (256)
+
+/******************************************************
+ *                 Type Definitions
+ ******************************************************/
+
+/*
+ * Message built by at_cmd_test_cmd_parser().
+ */
+
+typedef struct
+{
+    at_cmd_msg_base_t base;
+    uint32_t len;
+    char args[AT_CMD_TEST_MAX_ARGS];
+} at_cmd_test_msg_t;
+
+/******************************************************
+ *               Function Declarations
+ ******************************************************/
+
+/** Record the result of a check. */
+void at_cmd_test_check(bool ok, const char *expr, const char *file, int line);
+
+/** Print a summary of the checks.
+ *
+ * @return Process exit status, non-zero if any check failed.
+ */
+int at_cmd_test_finish(void);
+
+/** Initialize the library with push input and captured output.
+ *
+ * @param[in] params    : Optional parameters to start from, NULL for the defaults.
+ *                        The message queue and transport functions are filled in.
+ * @param[in] queue_len : Number of entries in the command message queue.
+ *
+ * @return Result of at_cmd_parser_init().
+ */
+cy_rslt_t at_cmd_test_init(at_cmd_params_t *params, uint32_t queue_len);
+
+/** Pass input to the library.
+ *
+ * @return Number of bytes consumed.
+ */
+uint32_t at_cmd_test_input(const void *data, uint32_t len);
+
+/** Get the output written since the last call to at_cmd_test_clear_output(). */
+const char *at_cmd_test_output(void);
+
+/** Get the length of the output, which may hold binary frames. */
+uint32_t at_cmd_test_output_len(void);
+
+/** Count the occurrences of a string in the output. */
+uint32_t at_cmd_test_output_count(const char *str);
+
+/** Make writes wait until the output is unblocked. */
+void at_cmd_test_block_output(bool block);
+
+/** Check whether a write is waiting for the output to be unblocked. */
+bool at_cmd_test_output_waiting(void);
+
+/** Discard the captured output. */
+void at_cmd_test_clear_output(void);
+
+/** Take the next message from the command message queue.
+ *
+ * @param[in] timeout_ms : Time to wait for a message.
+ *
+ * @return The message, or NULL if the queue is empty. Inline messages are copied
+ *         to allocated memory, so the message is always released with free().
+ */
+at_cmd_msg_base_t *at_cmd_test_get_msg(uint32_t timeout_ms);
+
+/** Free all of the queued messages.
+ *
+ * @return Number of messages freed.
+ */
+uint32_t at_cmd_test_drain(void);
+
+/** Command parser callback that copies the arguments into an at_cmd_test_msg_t. */
+at_cmd_msg_base_t *at_cmd_test_cmd_parser(uint32_t cmd_id, uint32_t serial, uint32_t cmd_args_len, uint8_t *cmd_args);
+
+/** Binary command callback that copies the data into an at_cmd_test_msg_t. */
+at_cmd_msg_base_t *at_cmd_test_binary_parser(uint32_t cmd_id, uint32_t serial, uint8_t *data, uint32_t data_len);
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file bench_compress.c
+ * @brief Compression CPU cost against wire time saved
+ *
+ * Compresses typical large asynchronous messages and compares the CPU time with the
+ * time saved on a UART at common baud rates. The CPU time is measured on the host.
+ * The "MCU slowdown" column is how many times slower than the host the target can
+ * be before compression costs more time than it saves on the wire.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "at_command_parser.h"
+#include "at_command_parser_private.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define BENCH_ITERATIONS                    (2000)
+#define BENCH_MAX_MSG                       (AT_CMD_MAX_SIZE)
+#define BENCH_BITS_PER_BYTE                 (10)        /* Start, 8 data and stop bit */
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static const uint32_t g_baud_rates[] = { 115200, 460800, 921600, 3000000 };
+
+static char g_msg[BENCH_MAX_MSG + 1];
+static uint8_t g_compressed[BENCH_MAX_MSG * 2];
+static uint16_t g_hash[1 << AT_CMD_COMPRESS_HASH_BITS];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static uint64_t bench_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+/** Build a scan result message with the given number of access points. */
+static uint32_t bench_scan_results(uint32_t count)
+{
+    uint32_t len;
+    uint32_t i;
+
+    len = (uint32_t)snprintf(g_msg, sizeof(g_msg), "ScanResult,{\"results\":[");
+    for (i = 0; i < count && len < sizeof(g_msg); i++)
+    {
+        len += (uint32_t)snprintf(&g_msg[len], sizeof(g_msg) - len,
+                                  "%s{\"ssid\":\"AP-%02lu-office\",\"bssid\":\"a4:2b:b0:%02lx:%02lx:%02lx\",\"rssi\":%ld,"
+                                  "\"channel\":%lu,\"band\":\"%s\",\"security\":\"WPA2_AES_PSK\"}",
+                                  (i == 0) ? "" : ",", (unsigned long)i, (unsigned long)(i * 7 & 0xff),
+                                  (unsigned long)(i * 13 & 0xff), (unsigned long)(i * 29 & 0xff), -40 - (long)(i * 3 % 50),
+                                  (unsigned long)(1 + i % 11), (i & 1) ? "5GHz" : "2.4GHz");
+    }
+    if (len < sizeof(g_msg))
+    {
+        len += (uint32_t)snprintf(&g_msg[len], sizeof(g_msg) - len, "]}");
+    }
+
+    return (len < sizeof(g_msg)) ? len : sizeof(g_msg) - 1;
+}
+
+
+/** Build a device shadow document. */
+static uint32_t bench_shadow(void)
+{
+    uint32_t len;
+    uint32_t i;
+
+    len = (uint32_t)snprintf(g_msg, sizeof(g_msg), "Shadow,{\"state\":{\"reported\":{");
+    for (i = 0; i < 16 && len < sizeof(g_msg); i++)
+    {
+        len += (uint32_t)snprintf(&g_msg[len], sizeof(g_msg) - len, "%s\"sensor%lu\":{\"value\":%lu,\"unit\":\"%s\",\"ok\":true}",
+                                  (i == 0) ? "" : ",", (unsigned long)i, (unsigned long)(i * 37 % 1000),
+                                  (i & 1) ? "celsius" : "percent");
+    }
+    if (len < sizeof(g_msg))
+    {
+        len += (uint32_t)snprintf(&g_msg[len], sizeof(g_msg) - len, "}},\"version\":42}");
+    }
+
+    return (len < sizeof(g_msg)) ? len : sizeof(g_msg) - 1;
+}
+
+
+static void bench_message(const char *name, uint32_t len)
+{
+    uint64_t start;
+    uint64_t cpu_ns;
+    uint64_t saved_ns;
+    uint32_t compressed = 0;
+    uint32_t i;
+
+    start = bench_time_ns();
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        compressed = at_cmd_compress((uint8_t *)g_msg, len, g_compressed, sizeof(g_compressed), g_hash);
+    }
+    cpu_ns = (bench_time_ns() - start) / BENCH_ITERATIONS;
+
+    printf("%-14s %5lu -> %5lu bytes (%3lu%%), host CPU %6.2f us\n", name, (unsigned long)len, (unsigned long)compressed,
+           (unsigned long)(compressed * 100u / len), (double)cpu_ns / 1000.0);
+
+    for (i = 0; i < sizeof(g_baud_rates) / sizeof(g_baud_rates[0]); i++)
+    {
+        saved_ns = (compressed < len) ? (uint64_t)(len - compressed) * BENCH_BITS_PER_BYTE * 1000000000u / g_baud_rates[i] : 0;
+        printf("    %7lu baud: wire %8.1f us -> %8.1f us, saved %8.1f us, MCU slowdown %6.0fx\n", (unsigned long)g_baud_rates[i],
+               (double)len * BENCH_BITS_PER_BYTE * 1e6 / g_baud_rates[i],
+               (double)compressed * BENCH_BITS_PER_BYTE * 1e6 / g_baud_rates[i], (double)saved_ns / 1000.0,
+               (cpu_ns > 0) ? (double)saved_ns / (double)cpu_ns : 0.0);
+    }
+}
+
+
+int main(void)
+{
+    bench_message("scan 4 APs", bench_scan_results(4));
+    bench_message("scan 20 APs", bench_scan_results(20));
+    bench_message("shadow", bench_shadow());
+
+    return 0;
+}
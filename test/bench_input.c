@@ -0,0 +1,216 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file bench_input.c
+ * @brief Transport read calls per KB of input
+ *
+ * Runs the input thread against a transport that delivers the data in bursts of a
+ * fixed size with a gap after each burst, and counts the is_data_ready() and
+ * read_data() calls made for each KB. Build with INPUT_BUFFER_SIZE and
+ * INPUT_READ_SIZE_MIN set to 64 to get the numbers for fixed 64 byte reads.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define BENCH_CMD_ID_PING                   (1)
+
+#define BENCH_INPUT_SIZE                    (64 * 1024)
+#define BENCH_QUEUE_LEN                     (64)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static const uint32_t g_burst_sizes[] = { 64, 256, 1024, 4096 };
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char g_input[BENCH_INPUT_SIZE];
+static uint32_t g_input_len;
+static uint32_t g_pos;
+static uint32_t g_burst_size;
+static uint32_t g_burst_left;
+static bool g_gap;
+static uint32_t g_ready_calls;
+static uint32_t g_read_calls;
+
+static cy_queue_t g_msg_queue;
+
+static at_cmd_def_t g_bench_cmds[] =
+{
+    { .cmd_name = "Ping", .cmd_id = BENCH_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static bool bench_is_data_ready(void *opaque)
+{
+    bool ready;
+
+    (void)opaque;
+
+    pthread_mutex_lock(&g_mutex);
+    if (g_pos == g_input_len)
+    {
+        pthread_mutex_unlock(&g_mutex);
+        return false;
+    }
+
+    g_ready_calls++;
+    if (g_burst_left == 0)
+    {
+        /*
+         * Leave a gap between bursts, then start the next one.
+         */
+
+        if (!g_gap)
+        {
+            g_burst_left = g_burst_size;
+        }
+        g_gap = !g_gap;
+    }
+    ready = (g_burst_left > 0);
+    pthread_mutex_unlock(&g_mutex);
+
+    return ready;
+}
+
+
+static uint32_t bench_read_data(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    (void)opaque;
+
+    pthread_mutex_lock(&g_mutex);
+    g_read_calls++;
+    if (length > g_burst_left)
+    {
+        length = g_burst_left;
+    }
+    if (length > g_input_len - g_pos)
+    {
+        length = g_input_len - g_pos;
+    }
+    memcpy(buffer, &g_input[g_pos], length);
+    g_pos        += length;
+    g_burst_left -= length;
+    pthread_mutex_unlock(&g_mutex);
+
+    return length;
+}
+
+
+static cy_rslt_t bench_write_data(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    (void)buffer;
+    (void)length;
+    (void)opaque;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+static void bench_run(uint32_t burst_size, uint32_t num_cmds)
+{
+    at_cmd_msg_queue_t entry;
+    uint32_t received = 0;
+
+    pthread_mutex_lock(&g_mutex);
+    g_pos         = 0;
+    g_burst_size  = burst_size;
+    g_burst_left  = 0;
+    g_gap         = false;
+    g_ready_calls = 0;
+    g_read_calls  = 0;
+    pthread_mutex_unlock(&g_mutex);
+
+    while (received < num_cmds)
+    {
+        if (cy_rtos_queue_get(&g_msg_queue, &entry, 1000) != CY_RSLT_SUCCESS)
+        {
+            fprintf(stderr, "bench: timed out after %lu commands\n", (unsigned long)received);
+            exit(1);
+        }
+        free(entry.msg);
+        received++;
+    }
+
+    pthread_mutex_lock(&g_mutex);
+    printf("burst %5lu bytes: %7.2f is_data_ready and %7.2f read_data calls per KB\n", (unsigned long)burst_size,
+           (double)g_ready_calls * 1024.0 / g_input_len, (double)g_read_calls * 1024.0 / g_input_len);
+    pthread_mutex_unlock(&g_mutex);
+}
+
+
+int main(void)
+{
+    at_cmd_params_t params;
+    uint32_t num_cmds = 0;
+    uint32_t i;
+
+    while (g_input_len < BENCH_INPUT_SIZE - 32)
+    {
+        g_input_len += (uint32_t)sprintf(&g_input[g_input_len], "AT+0004%lu;Ping;", (unsigned long)(num_cmds % 1000 + 1));
+        num_cmds++;
+    }
+
+    memset(&params, 0, sizeof(params));
+    cy_rtos_queue_init(&g_msg_queue, BENCH_QUEUE_LEN, AT_CMD_MSG_QUEUE_ENTRY_SIZE(0));
+    params.cmd_msg_queue = &g_msg_queue;
+    params.is_data_ready = bench_is_data_ready;
+    params.read_data     = bench_read_data;
+    params.write_data    = bench_write_data;
+    if (at_cmd_parser_init(&params) != CY_RSLT_SUCCESS ||
+        at_cmd_parser_register_commands(g_bench_cmds, sizeof(g_bench_cmds) / sizeof(g_bench_cmds[0])) != CY_RSLT_SUCCESS)
+    {
+        fprintf(stderr, "bench: library initialization failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < sizeof(g_burst_sizes) / sizeof(g_burst_sizes[0]); i++)
+    {
+        bench_run(g_burst_sizes[i], num_cmds);
+    }
+
+    return 0;
+}
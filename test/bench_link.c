@@ -0,0 +1,347 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+/**
+ * @file bench_link.c
+ * @brief Push input from an epoll loop against the polling input thread
+ *
+ * Runs one link over a socketpair and measures the command round trip time, the
+ * pipelined command rate and the CPU time used while the link is idle. By default
+ * input is read by an epoll loop and passed to at_cmd_parser_input(). Build with
+ * BENCH_LINK_THREAD defined to measure the input thread instead.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define BENCH_CMD_ID_PING                   (1)
+
+#define BENCH_QUEUE_LEN                     (64)
+#define BENCH_ROUND_TRIPS                   (2000)
+#define BENCH_PIPELINED                     (50000)
+#define BENCH_WINDOW                        (32)
+#define BENCH_IDLE_MS                       (1000)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+/*
+ * g_fd[0] is the module end of the link, g_fd[1] the host end.
+ */
+
+static int g_fd[2];
+
+static cy_queue_t g_msg_queue;
+
+static at_cmd_def_t g_bench_cmds[] =
+{
+    { .cmd_name = "Ping", .cmd_id = BENCH_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static uint64_t bench_time_ns(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+static cy_rslt_t bench_write_data(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    ssize_t count;
+
+    (void)opaque;
+
+    while (length > 0)
+    {
+        count = write(g_fd[0], buffer, length);
+        if (count <= 0)
+        {
+            return CY_AT_CMD_PARSER_ERROR;
+        }
+        buffer += count;
+        length -= (uint32_t)count;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+#ifdef BENCH_LINK_THREAD
+static bool bench_is_data_ready(void *opaque)
+{
+    struct pollfd pfd = { .fd = g_fd[0], .events = POLLIN };
+
+    (void)opaque;
+
+    return (poll(&pfd, 1, 0) > 0);
+}
+
+
+static uint32_t bench_read_data(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    ssize_t count;
+
+    (void)opaque;
+
+    count = recv(g_fd[0], buffer, length, MSG_DONTWAIT);
+
+    return (count > 0) ? (uint32_t)count : 0;
+}
+#else
+/** Event loop. Waits for the link with epoll and pushes what it reads into the library. */
+static void *bench_event_thread(void *arg)
+{
+    struct epoll_event event = { .events = EPOLLIN };
+    uint8_t buffer[4096];
+    uint32_t consumed;
+    ssize_t count;
+    ssize_t pos;
+    int epfd;
+
+    (void)arg;
+
+    epfd = epoll_create1(0);
+    event.data.fd = g_fd[0];
+    epoll_ctl(epfd, EPOLL_CTL_ADD, g_fd[0], &event);
+
+    while (1)
+    {
+        if (epoll_wait(epfd, &event, 1, -1) <= 0)
+        {
+            continue;
+        }
+
+        count = read(g_fd[0], buffer, sizeof(buffer));
+        for (pos = 0; pos < count; pos += consumed)
+        {
+            /*
+             * Nothing is consumed while flow control has input stopped.
+             */
+
+            consumed = at_cmd_parser_input(&buffer[pos], (uint32_t)(count - pos));
+            if (consumed == 0)
+            {
+                usleep(100);
+            }
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+
+/** Application. Answers each command as it is taken from the queue. */
+static void *bench_app_thread(void *arg)
+{
+    at_cmd_msg_queue_t entry;
+    uint32_t serial;
+
+    (void)arg;
+
+    while (1)
+    {
+        if (cy_rtos_queue_get(&g_msg_queue, &entry, CY_RTOS_NEVER_TIMEOUT) != CY_RSLT_SUCCESS)
+        {
+            continue;
+        }
+        serial = entry.msg->serial;
+        free(entry.msg);
+        at_cmd_parser_send_cmd_response(serial, AT_CMD_STATUS_SUCCESS, NULL);
+    }
+
+    return NULL;
+}
+
+
+static void bench_send(uint32_t serial)
+{
+    char cmd[32];
+    int len;
+
+    len = sprintf(cmd, "AT+0004%lu;Ping;", (unsigned long)serial);
+    if (write(g_fd[1], cmd, (size_t)len) != len)
+    {
+        fprintf(stderr, "bench: write failed: %s\n", strerror(errno));
+        exit(1);
+    }
+}
+
+
+/** Read from the host end of the link.
+ *
+ * @return Number of responses read. Each response ends with a line feed.
+ */
+
+static uint32_t bench_receive(void)
+{
+    char buffer[4096];
+    uint32_t responses = 0;
+    ssize_t count;
+    ssize_t i;
+
+    count = read(g_fd[1], buffer, sizeof(buffer));
+    if (count <= 0)
+    {
+        fprintf(stderr, "bench: read failed\n");
+        exit(1);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (buffer[i] == '\n')
+        {
+            responses++;
+        }
+    }
+
+    return responses;
+}
+
+
+static void bench_round_trips(void)
+{
+    uint64_t start;
+    uint64_t elapsed;
+    uint64_t total = 0;
+    uint64_t worst = 0;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_ROUND_TRIPS; i++)
+    {
+        start = bench_time_ns(CLOCK_MONOTONIC);
+        bench_send(i % 1000 + 1);
+        while (bench_receive() == 0)
+        {
+        }
+        elapsed = bench_time_ns(CLOCK_MONOTONIC) - start;
+        total  += elapsed;
+        worst   = (elapsed > worst) ? elapsed : worst;
+    }
+
+    printf("  round trip   %8.1f us average, %8.1f us worst\n", total / 1000.0 / BENCH_ROUND_TRIPS, worst / 1000.0);
+}
+
+
+static void bench_pipelined(void)
+{
+    uint32_t sent = 0;
+    uint32_t answered = 0;
+    uint64_t start;
+
+    start = bench_time_ns(CLOCK_MONOTONIC);
+    while (answered < BENCH_PIPELINED)
+    {
+        while (sent < BENCH_PIPELINED && sent - answered < BENCH_WINDOW)
+        {
+            bench_send(sent % 1000 + 1);
+            sent++;
+        }
+        answered += bench_receive();
+    }
+
+    printf("  pipelined    %8.0f commands/s with %u in flight\n",
+           BENCH_PIPELINED * 1e9 / (double)(bench_time_ns(CLOCK_MONOTONIC) - start), BENCH_WINDOW);
+}
+
+
+static void bench_idle(void)
+{
+    uint64_t start;
+
+    start = bench_time_ns(CLOCK_PROCESS_CPUTIME_ID);
+    usleep(BENCH_IDLE_MS * 1000);
+
+    printf("  idle link    %8.2f ms of CPU per second\n",
+           (bench_time_ns(CLOCK_PROCESS_CPUTIME_ID) - start) / 1e6 / (BENCH_IDLE_MS / 1000.0));
+}
+
+
+int main(void)
+{
+    at_cmd_params_t params;
+    pthread_t thread;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, g_fd) != 0)
+    {
+        fprintf(stderr, "bench: socketpair failed: %s\n", strerror(errno));
+        return 1;
+    }
+
+    memset(&params, 0, sizeof(params));
+    cy_rtos_queue_init(&g_msg_queue, BENCH_QUEUE_LEN, AT_CMD_MSG_QUEUE_ENTRY_SIZE(0));
+    params.cmd_msg_queue = &g_msg_queue;
+    params.write_data    = bench_write_data;
+#ifdef BENCH_LINK_THREAD
+    params.is_data_ready = bench_is_data_ready;
+    params.read_data     = bench_read_data;
+#endif
+    if (at_cmd_parser_init(&params) != CY_RSLT_SUCCESS ||
+        at_cmd_parser_register_commands(g_bench_cmds, sizeof(g_bench_cmds) / sizeof(g_bench_cmds[0])) != CY_RSLT_SUCCESS)
+    {
+        fprintf(stderr, "bench: library initialization failed\n");
+        return 1;
+    }
+
+    pthread_create(&thread, NULL, bench_app_thread, NULL);
+#ifndef BENCH_LINK_THREAD
+    pthread_create(&thread, NULL, bench_event_thread, NULL);
+#endif
+
+    bench_round_trips();
+    bench_pipelined();
+    bench_idle();
+
+    return 0;
+}
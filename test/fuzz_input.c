@@ -0,0 +1,502 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file fuzz_input.c
+ * @brief Fuzz target for the command framer
+ *
+ * Built with AT_CMD_FUZZ_LIBFUZZER this is a libFuzzer target on at_cmd_parser_input().
+ * Otherwise it is a standalone driver that feeds generated hostile input through the
+ * same entry point and fails if any input takes longer than the latency budget.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "at_cmd_test.h"
+#include "at_command_parser_private.h"
+
+/******************************************************
+ *                     Macros
+ ******************************************************/
+
+#ifndef AT_CMD_FUZZ_ITERATIONS
+#define AT_CMD_FUZZ_ITERATIONS              (20000)     /* Inputs generated by the standalone driver */
+#endif
+
+#ifndef AT_CMD_FUZZ_BUDGET_FIXED_US
+#define AT_CMD_FUZZ_BUDGET_FIXED_US         (5000)      /* Latency budget for any input              */
+#endif
+
+#ifndef AT_CMD_FUZZ_BUDGET_NS_PER_BYTE
+#define AT_CMD_FUZZ_BUDGET_NS_PER_BYTE      (1000)      /* Latency budget added for each input byte  */
+#endif
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define FUZZ_CMD_ID_PING                    (1)
+#define FUZZ_CMD_ID_ECHO                    (2)
+#define FUZZ_CMD_ID_UPLOAD                  (3)
+#define FUZZ_CMD_ID_NEVER                   (4)
+
+#define FUZZ_MAX_INPUT                      (16 * 1024)
+#define FUZZ_QUEUE_LEN                      (4096)
+#define FUZZ_RETRIES                        (3)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static uint8_t g_stream_context;
+static uint32_t g_never_count;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static cy_rslt_t fuzz_stream_begin(uint32_t cmd_id, uint32_t serial, uint32_t data_len, void **context)
+{
+    (void)cmd_id;
+    (void)serial;
+    (void)data_len;
+
+    *context = &g_stream_context;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+static cy_rslt_t fuzz_stream_data(void *context, uint8_t *data, uint32_t len)
+{
+    (void)context;
+    (void)data;
+    (void)len;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+static at_cmd_msg_base_t *fuzz_stream_end(void *context, bool complete)
+{
+    (void)context;
+
+    if (!complete)
+    {
+        return NULL;
+    }
+
+    return at_cmd_test_cmd_parser(FUZZ_CMD_ID_UPLOAD, 0, 0, (uint8_t *)"");
+}
+
+
+/** Parser for a command that is only ever sent inside binary data, so it must never run. */
+static at_cmd_msg_base_t *fuzz_never_parser(uint32_t cmd_id, uint32_t serial, uint32_t cmd_args_len, uint8_t *cmd_args)
+{
+    (void)cmd_id;
+    (void)serial;
+    (void)cmd_args_len;
+    (void)cmd_args;
+
+    g_never_count++;
+
+    return NULL;
+}
+
+
+static const at_cmd_stream_callbacks_t g_fuzz_stream_callbacks =
+{
+    .begin = fuzz_stream_begin,
+    .data  = fuzz_stream_data,
+    .end   = fuzz_stream_end,
+};
+
+static const at_cmd_limits_t g_echo_limits =
+{
+    .max_in_flight = 4,
+    .rate          = 0,
+    .burst         = 0,
+};
+
+static at_cmd_def_t g_fuzz_cmds[] =
+{
+    { .cmd_name = "Ping", .cmd_id = FUZZ_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser, .binary_parser = at_cmd_test_binary_parser },
+    { .cmd_name = "Echo", .cmd_id = FUZZ_CMD_ID_ECHO, .cmd_parser = at_cmd_test_cmd_parser, .limits = &g_echo_limits },
+    { .cmd_name = "Upload", .cmd_id = FUZZ_CMD_ID_UPLOAD, .stream_callbacks = &g_fuzz_stream_callbacks },
+    { .cmd_name = "Never", .cmd_id = FUZZ_CMD_ID_NEVER, .cmd_parser = fuzz_never_parser },
+};
+
+
+static void fuzz_setup(void)
+{
+    static bool initialized;
+
+    if (initialized)
+    {
+        return;
+    }
+    initialized = true;
+
+    if (at_cmd_test_init(NULL, FUZZ_QUEUE_LEN) != CY_RSLT_SUCCESS ||
+        at_cmd_parser_register_commands(g_fuzz_cmds, sizeof(g_fuzz_cmds) / sizeof(g_fuzz_cmds[0])) != CY_RSLT_SUCCESS)
+    {
+        fprintf(stderr, "fuzz: library initialization failed\n");
+        abort();
+    }
+}
+
+
+/** Answer every queued command so the response, batch and limit paths are exercised too. */
+static void fuzz_respond(void)
+{
+    at_cmd_msg_base_t *msg;
+
+    while ((msg = at_cmd_test_get_msg(0)) != NULL)
+    {
+        at_cmd_parser_send_cmd_response(msg->serial, (msg->serial & 1) ? AT_CMD_STATUS_ERROR : AT_CMD_STATUS_SUCCESS, "ok");
+        free(msg);
+    }
+    at_cmd_test_clear_output();
+}
+
+
+/** Pass one input to the library in chunks. The first byte gives the chunk size.
+ *
+ * @param[in] data : Input data.
+ * @param[in] size : Length of the input.
+ */
+
+static void fuzz_one_input(const uint8_t *data, size_t size)
+{
+    uint32_t chunk;
+    uint32_t len;
+
+    if (size == 0)
+    {
+        return;
+    }
+
+    chunk = (data[0] == 0) ? (uint32_t)size : data[0];
+    data++;
+    size--;
+
+    while (size > 0)
+    {
+        len = (size < chunk) ? (uint32_t)size : chunk;
+        at_cmd_test_input(data, len);
+        data += len;
+        size -= len;
+    }
+
+    fuzz_respond();
+}
+
+
+#ifdef AT_CMD_FUZZ_LIBFUZZER
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_setup();
+    fuzz_one_input(data, size);
+
+    return 0;
+}
+#else
+/*
+ * Standalone driver. Builds inputs from valid frames, mutations of them and hostile
+ * patterns, and checks the time each input takes against the latency budget.
+ */
+
+static uint32_t g_rand_state = 0x12345678;
+static bool g_never_check;
+
+static uint8_t g_input[FUZZ_MAX_INPUT + 1];
+
+static const char *g_frames[] =
+{
+    "AT+00041;Ping;",
+    "AT+000712;Echo,{};",
+    "AT+0000\rAT+00003;Echo,x\r",
+    "AT+B00084;Ping,\x01;\x02;",
+    "AT+L000000135;Upload,;;;;;;;",
+    "AT+00246;Batch,Ping\x1e" "Echo,[1]\x1e" "Ping;",
+    "AT+00047@100;Ping;",
+    "AT%1,0014;AT+00048;Ping;",
+    "AT+00049;Nope;",
+    "AT+00061;Ping;\r\n",
+    "AT+00051;Ping\n",
+};
+
+
+static uint32_t fuzz_rand(void)
+{
+    g_rand_state ^= g_rand_state << 13;
+    g_rand_state ^= g_rand_state >> 17;
+    g_rand_state ^= g_rand_state << 5;
+
+    return g_rand_state;
+}
+
+
+static uint32_t fuzz_append(uint32_t len, const void *data, uint32_t count)
+{
+    if (count > FUZZ_MAX_INPUT - len)
+    {
+        count = FUZZ_MAX_INPUT - len;
+    }
+    memcpy(&g_input[len], data, count);
+
+    return len + count;
+}
+
+
+/** Generate one input in g_input.
+ *
+ * @return Length of the input.
+ */
+
+static uint32_t fuzz_generate(void)
+{
+    static const char noise_chars[] = "AT+%BL;,@\r\n0123456789\x1e";
+    const char *frame;
+    uint32_t len = 1;
+    uint32_t count;
+    uint32_t i;
+
+    g_input[0] = (uint8_t)fuzz_rand();
+
+    g_never_check = false;
+    g_never_count = 0;
+
+    switch (fuzz_rand() % 6)
+    {
+        case 0:
+            /*
+             * Valid frames, mutated.
+             */
+
+            count = 1 + fuzz_rand() % 200;
+            for (i = 0; i < count; i++)
+            {
+                frame = g_frames[fuzz_rand() % (sizeof(g_frames) / sizeof(g_frames[0]))];
+                len   = fuzz_append(len, frame, (uint32_t)strlen(frame));
+            }
+            count = fuzz_rand() % 16;
+            for (i = 0; i < count && len > 1; i++)
+            {
+                g_input[1 + fuzz_rand() % (len - 1)] = (uint8_t)noise_chars[fuzz_rand() % (sizeof(noise_chars) - 1)];
+            }
+            break;
+
+        case 1:
+            /*
+             * Noise made of characters that mean something to the framer.
+             */
+
+            count = fuzz_rand() % FUZZ_MAX_INPUT;
+            for (i = 0; i < count; i++)
+            {
+                g_input[len++] = (uint8_t)noise_chars[fuzz_rand() % (sizeof(noise_chars) - 1)];
+            }
+            break;
+
+        case 2:
+            /*
+             * Random bytes.
+             */
+
+            count = fuzz_rand() % FUZZ_MAX_INPUT;
+            for (i = 0; i < count; i++)
+            {
+                g_input[len++] = (uint8_t)fuzz_rand();
+            }
+            break;
+
+        case 3:
+            /*
+             * A maximum length frame with a bad trailer whose data is made of short bad headers,
+             * so that the rescan after the trailer error finds as many frames as possible. Or
+             * nested frames that all end at the same bad trailer.
+             */
+
+            if (fuzz_rand() & 1)
+            {
+                len = fuzz_append(len, "AT+60001;", 9);
+                while (len < 6010)
+                {
+                    frame = (fuzz_rand() & 1) ? "AT+" : "AT+0004";
+                    len   = fuzz_append(len, frame, (uint32_t)strlen(frame));
+                }
+                len = 6010;
+            }
+            else
+            {
+                while (len < 6010 - 9)
+                {
+                    len += (uint32_t)sprintf((char *)&g_input[len], "AT+%04lu1;", (unsigned long)(6010 - 9 - len));
+                }
+                while (len < 6010)
+                {
+                    g_input[len++] = 'x';
+                }
+            }
+            len = fuzz_append(len, "!", 1);
+            break;
+
+        case 4:
+            /*
+             * Binary frames with bad trailers whose data holds commands. The data is opaque
+             * and the commands in it must never run. The padding first ends any frame left
+             * open by the previous input.
+             */
+
+            memset(&g_input[len], 'x', 10000);
+            len += 10000;
+            count = 1 + fuzz_rand() % 8;
+            for (i = 0; i < count; i++)
+            {
+                len += (uint32_t)sprintf((char *)&g_input[len], "AT+B0020%lu;Ping,AT+00059;Never;%c", (unsigned long)(fuzz_rand() % 1000),
+                                         (fuzz_rand() & 1) ? ';' : '!');
+            }
+            g_never_check = true;
+            break;
+
+        default:
+            /*
+             * Long serial numbers and sizes in every frame type.
+             */
+
+            frame = (fuzz_rand() & 1) ? "AT+L0000010" : ((fuzz_rand() & 1) ? "AT+B0004" : "AT+0004");
+            len   = fuzz_append(len, frame, (uint32_t)strlen(frame));
+            count = (fuzz_rand() & 1) ? fuzz_rand() % 8000 : AT_CMD_PARSER_BUFFER_SIZE - 12 - fuzz_rand() % 80;
+            for (i = 0; i < count && len < FUZZ_MAX_INPUT; i++)
+            {
+                g_input[len++] = (uint8_t)('0' + fuzz_rand() % 10);
+            }
+            len   = fuzz_append(len, ";", 1);
+            count = fuzz_rand() % 80;
+            for (i = 0; i < count && len < FUZZ_MAX_INPUT; i++)
+            {
+                g_input[len++] = 'n';
+            }
+            len = fuzz_append(len, ",xxxxxxxx;AT+00041;Ping;", 24);
+            break;
+    }
+
+    return len;
+}
+
+
+static uint64_t fuzz_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint64_t budget_ns;
+    uint64_t best_ns;
+    uint64_t elapsed;
+    uint64_t worst_ns = 0;
+    uint32_t worst_len = 0;
+    uint32_t iterations = AT_CMD_FUZZ_ITERATIONS;
+    uint32_t failures = 0;
+    uint32_t len;
+    uint32_t i;
+    uint32_t j;
+
+    if (argc > 1)
+    {
+        g_rand_state = (uint32_t)strtoul(argv[1], NULL, 0) | 1;
+    }
+    if (argc > 2)
+    {
+        iterations = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+
+    fuzz_setup();
+
+    for (i = 0; i < iterations; i++)
+    {
+        len       = fuzz_generate();
+        budget_ns = (uint64_t)AT_CMD_FUZZ_BUDGET_FIXED_US * 1000u + (uint64_t)len * AT_CMD_FUZZ_BUDGET_NS_PER_BYTE;
+
+        /*
+         * Take the best of a few runs so that being preempted doesn't fail the budget.
+         */
+
+        best_ns = UINT64_MAX;
+        for (j = 0; j < FUZZ_RETRIES && best_ns > budget_ns; j++)
+        {
+            elapsed = fuzz_time_ns();
+            fuzz_one_input(g_input, len);
+            elapsed = fuzz_time_ns() - elapsed;
+            if (elapsed < best_ns)
+            {
+                best_ns = elapsed;
+            }
+        }
+
+        if (g_never_check && g_never_count != 0)
+        {
+            failures++;
+            g_never_count = 0;
+            fprintf(stderr, "fuzz: input %lu ran a command from the data of a binary command\n", (unsigned long)i);
+        }
+
+        if (best_ns > worst_ns)
+        {
+            worst_ns  = best_ns;
+            worst_len = len;
+        }
+        if (best_ns > budget_ns)
+        {
+            failures++;
+            fprintf(stderr, "fuzz: input %lu of %lu bytes took %lu us, budget %lu us\n", (unsigned long)i,
+                    (unsigned long)len, (unsigned long)(best_ns / 1000u), (unsigned long)(budget_ns / 1000u));
+        }
+    }
+
+    printf("%lu inputs, slowest %lu us for %lu bytes, %lu failed\n", (unsigned long)iterations,
+           (unsigned long)(worst_ns / 1000u), (unsigned long)worst_len, (unsigned long)failures);
+
+    return (failures == 0) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file cyabs_rtos_host.c
+ * @brief RTOS abstraction subset for host builds of the library tests
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cyabs_rtos.h"
+
+/******************************************************
+ *                    Structures
+ ******************************************************/
+
+typedef struct
+{
+    cy_thread_entry_fn_t entry_function;
+    cy_thread_arg_t arg;
+} cy_thread_start_t;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static void *cy_rtos_thread_start(void *arg)
+{
+    cy_thread_start_t start = *(cy_thread_start_t *)arg;
+
+    free(arg);
+    start.entry_function(start.arg);
+
+    return NULL;
+}
+
+
+static void cy_rtos_deadline(struct timespec *ts, cy_time_t timeout_ms)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec  += timeout_ms / 1000;
+    ts->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+
+cy_rslt_t cy_rtos_create_thread(cy_thread_t *thread, cy_thread_entry_fn_t entry_function, const char *name, void *stack,
+                                uint32_t stack_size, cy_thread_priority_t priority, cy_thread_arg_t arg)
+{
+    cy_thread_start_t *start;
+
+    (void)name;
+    (void)stack;
+    (void)stack_size;
+    (void)priority;
+
+    start = malloc(sizeof(cy_thread_start_t));
+    if (start == NULL)
+    {
+        return CY_RTOS_GENERAL_ERROR;
+    }
+    start->entry_function = entry_function;
+    start->arg            = arg;
+
+    if (pthread_create(thread, NULL, cy_rtos_thread_start, start) != 0)
+    {
+        free(start);
+        return CY_RTOS_GENERAL_ERROR;
+    }
+    pthread_detach(*thread);
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_mutex_init(cy_mutex_t *mutex, bool recursive)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    if (recursive)
+    {
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    }
+
+    return (pthread_mutex_init(mutex, &attr) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_mutex_get(cy_mutex_t *mutex, cy_time_t timeout_ms)
+{
+    struct timespec ts;
+
+    if (timeout_ms == CY_RTOS_NEVER_TIMEOUT)
+    {
+        return (pthread_mutex_lock(mutex) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+    }
+
+    cy_rtos_deadline(&ts, timeout_ms);
+
+    return (pthread_mutex_timedlock(mutex, &ts) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_TIMEOUT;
+}
+
+cy_rslt_t cy_rtos_mutex_set(cy_mutex_t *mutex)
+{
+    return (pthread_mutex_unlock(mutex) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_mutex_deinit(cy_mutex_t *mutex)
+{
+    return (pthread_mutex_destroy(mutex) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_semaphore_init(cy_semaphore_t *semaphore, uint32_t maxcount, uint32_t initcount)
+{
+    (void)maxcount;
+
+    return (sem_init(semaphore, 0, initcount) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_semaphore_get(cy_semaphore_t *semaphore, cy_time_t timeout_ms)
+{
+    struct timespec ts;
+    int rc;
+
+    if (timeout_ms == CY_RTOS_NEVER_TIMEOUT)
+    {
+        while ((rc = sem_wait(semaphore)) != 0 && errno == EINTR)
+        {
+        }
+        return (rc == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+    }
+
+    cy_rtos_deadline(&ts, timeout_ms);
+    while ((rc = sem_timedwait(semaphore, &ts)) != 0 && errno == EINTR)
+    {
+    }
+
+    return (rc == 0) ? CY_RSLT_SUCCESS : CY_RTOS_TIMEOUT;
+}
+
+cy_rslt_t cy_rtos_semaphore_set(cy_semaphore_t *semaphore)
+{
+    return (sem_post(semaphore) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_semaphore_deinit(cy_semaphore_t *semaphore)
+{
+    return (sem_destroy(semaphore) == 0) ? CY_RSLT_SUCCESS : CY_RTOS_GENERAL_ERROR;
+}
+
+cy_rslt_t cy_rtos_queue_init(cy_queue_t *queue, size_t length, size_t itemsize)
+{
+    queue->buffer = malloc(length * itemsize);
+    if (queue->buffer == NULL)
+    {
+        return CY_RTOS_GENERAL_ERROR;
+    }
+
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    queue->length   = length;
+    queue->itemsize = itemsize;
+    queue->head     = 0;
+    queue->count    = 0;
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_queue_deinit(cy_queue_t *queue)
+{
+    pthread_cond_destroy(&queue->cond);
+    pthread_mutex_destroy(&queue->mutex);
+    free(queue->buffer);
+    queue->buffer = NULL;
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_queue_put(cy_queue_t *queue, const void *item_ptr, cy_time_t timeout_ms)
+{
+    struct timespec ts;
+
+    cy_rtos_deadline(&ts, timeout_ms);
+
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == queue->length)
+    {
+        if (timeout_ms == 0 || pthread_cond_timedwait(&queue->cond, &queue->mutex, &ts) != 0)
+        {
+            pthread_mutex_unlock(&queue->mutex);
+            return CY_RTOS_TIMEOUT;
+        }
+    }
+
+    memcpy(&queue->buffer[((queue->head + queue->count) % queue->length) * queue->itemsize], item_ptr, queue->itemsize);
+    queue->count++;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_queue_get(cy_queue_t *queue, void *item_ptr, cy_time_t timeout_ms)
+{
+    struct timespec ts;
+
+    cy_rtos_deadline(&ts, timeout_ms);
+
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == 0)
+    {
+        if (timeout_ms == 0 || pthread_cond_timedwait(&queue->cond, &queue->mutex, &ts) != 0)
+        {
+            pthread_mutex_unlock(&queue->mutex);
+            return CY_RTOS_TIMEOUT;
+        }
+    }
+
+    memcpy(item_ptr, &queue->buffer[queue->head * queue->itemsize], queue->itemsize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_queue_count(cy_queue_t *queue, size_t *num_waiting)
+{
+    pthread_mutex_lock(&queue->mutex);
+    *num_waiting = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_queue_space(cy_queue_t *queue, size_t *num_spaces)
+{
+    pthread_mutex_lock(&queue->mutex);
+    *num_spaces = queue->length - queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_delay_milliseconds(cy_time_t num_ms)
+{
+    usleep((useconds_t)num_ms * 1000);
+
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_rtos_get_time(cy_time_t *tval)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *tval = (cy_time_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+
+    return CY_RSLT_SUCCESS;
+}
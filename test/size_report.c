@@ -0,0 +1,108 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file size_report.c
+ * @brief Print the memory footprint of the build profile
+ *
+ * Initializes the library with an input thread, the way a device uses it, and prints
+ * the footprint reported by at_cmd_parser_get_footprint().
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "at_command_parser.h"
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static cy_queue_t g_msg_queue;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static bool size_is_data_ready(void *opaque)
+{
+    (void)opaque;
+
+    return false;
+}
+
+
+static uint32_t size_read_data(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    (void)buffer;
+    (void)length;
+    (void)opaque;
+
+    return 0;
+}
+
+
+static cy_rslt_t size_write_data(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    (void)buffer;
+    (void)length;
+    (void)opaque;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+int main(void)
+{
+    at_cmd_params_t params;
+    at_cmd_footprint_t footprint;
+
+    memset(&params, 0, sizeof(params));
+    cy_rtos_queue_init(&g_msg_queue, 4, AT_CMD_MSG_QUEUE_ENTRY_SIZE(0));
+    params.cmd_msg_queue = &g_msg_queue;
+    params.is_data_ready = size_is_data_ready;
+    params.read_data     = size_read_data;
+    params.write_data    = size_write_data;
+
+    if (at_cmd_parser_init(&params) != CY_RSLT_SUCCESS || at_cmd_parser_get_footprint(&footprint) != CY_RSLT_SUCCESS)
+    {
+        fprintf(stderr, "size: library initialization failed\n");
+        return 1;
+    }
+
+    printf("  parser state %lu bytes, thread stacks %lu bytes, command buffers %lu bytes, largest command %lu bytes\n",
+           (unsigned long)footprint.static_ram, (unsigned long)footprint.thread_stacks, (unsigned long)footprint.buffer_size,
+           (unsigned long)footprint.max_cmd_size);
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_compress.c
+ * @brief Compressed asynchronous messages from several threads
+ *
+ * Senders building frames in different output buffers at the same time must
+ * each produce data that decompresses to their own message.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+#include "at_command_parser_private.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_SENDERS                        (4)
+#define TEST_MESSAGES                       (5000)
+#define TEST_TEXT_SIZE                      (1024)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static char g_text[TEST_SENDERS][TEST_TEXT_SIZE];
+static uint32_t g_frames;
+static uint32_t g_bad_frames;
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Asynchronous transport that checks each frame and completes the write at once.
+ *
+ * Writes are started with the library's output mutex held, so only one runs at a time.
+ */
+
+static cy_rslt_t test_write_async(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    uint8_t text[TEST_TEXT_SIZE];
+    unsigned int size;
+    unsigned int serial;
+    uint32_t len;
+    char *data;
+
+    (void)opaque;
+
+    g_frames++;
+    data = memchr(buffer, ';', length);
+    if (length < 2 || buffer[1] != AT_CMD_COMPRESSED_MSG_TYPE || data == NULL ||
+        sscanf((char *)&buffer[2], "%4u,%u", &size, &serial) != 2 || serial >= TEST_SENDERS)
+    {
+        g_bad_frames++;
+    }
+    else
+    {
+        len = at_cmd_decompress((uint8_t *)data + 1, size, text, sizeof(text) - 1);
+        if (len != strlen(g_text[serial]) || memcmp(text, g_text[serial], len) != 0)
+        {
+            g_bad_frames++;
+        }
+    }
+
+    return at_cmd_parser_write_complete(CY_RSLT_SUCCESS);
+}
+
+
+static void *test_sender(void *arg)
+{
+    uint32_t serial = (uint32_t)(uintptr_t)arg;
+    uint32_t i;
+
+    for (i = 0; i < TEST_MESSAGES; i++)
+    {
+        at_cmd_parser_send_cmd_async_response_compressed(serial, g_text[serial]);
+    }
+
+    return NULL;
+}
+
+
+int main(void)
+{
+    pthread_t threads[TEST_SENDERS];
+    at_cmd_params_t params;
+    uint32_t len;
+    uint32_t i;
+    uint32_t j;
+
+    /*
+     * Compressible messages that differ between senders.
+     */
+
+    for (i = 0; i < TEST_SENDERS; i++)
+    {
+        len = (uint32_t)sprintf(g_text[i], "Scan,[");
+        for (j = 0; j < 12; j++)
+        {
+            len += (uint32_t)sprintf(&g_text[i][len], "%s{\"ssid\":\"sender%lu-%lu\",\"rssi\":-%lu,\"channel\":%lu}",
+                                     (j > 0) ? "," : "", (unsigned long)i, (unsigned long)j, (unsigned long)(40 + i * 7 + j),
+                                     (unsigned long)(1 + (i + j) % 11));
+        }
+        strcpy(&g_text[i][len], "]");
+    }
+
+    memset(&params, 0, sizeof(params));
+    params.write_data_async = test_write_async;
+    AT_CMD_TEST_CHECK(at_cmd_test_init(&params, 4) == CY_RSLT_SUCCESS);
+
+    for (i = 0; i < TEST_SENDERS; i++)
+    {
+        pthread_create(&threads[i], NULL, test_sender, (void *)(uintptr_t)i);
+    }
+
+    for (i = 0; i < TEST_SENDERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    AT_CMD_TEST_CHECK(g_frames == TEST_SENDERS * TEST_MESSAGES);
+    AT_CMD_TEST_CHECK(g_bad_frames == 0);
+
+    return at_cmd_test_finish();
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_diag.c
+ * @brief Diagnostic commands
+ *
+ * Checks that only commands from the registered diagnostic table are run by the library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_HIGH                    (AT_CMD_DIAG_CMD_ID_BASE + 2)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "High", .cmd_id = TEST_CMD_ID_HIGH, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static void test_app_cmd_id(void)
+{
+    at_cmd_test_msg_t *msg;
+
+    /*
+     * An application command that uses an id in the diagnostic range is queued,
+     * whether or not the diagnostic commands are registered.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00061;High,x;");
+    msg = (at_cmd_test_msg_t *)at_cmd_test_get_msg(0);
+    AT_CMD_TEST_CHECK(msg != NULL && msg->base.cmd_id == TEST_CMD_ID_HIGH && strcmp(msg->args, "x") == 0);
+    free(msg);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_diag_commands() == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_INPUT("AT+00062;High,y;");
+    msg = (at_cmd_test_msg_t *)at_cmd_test_get_msg(0);
+    AT_CMD_TEST_CHECK(msg != NULL && msg->base.cmd_id == TEST_CMD_ID_HIGH && strcmp(msg->args, "y") == 0);
+    free(msg);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S") == 0);
+}
+
+
+static void test_diag_cmds(void)
+{
+    AT_CMD_TEST_INPUT("AT+00143;DiagEcho,hello;");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0007,3;0,hello;") == 1);
+
+    AT_CMD_TEST_INPUT("AT+00364;DiagSource,{\"bytes\":1000,\"size\":100};");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+H") == 10);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S") == 2);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("\"bytes\":1000,\"frames\":10") == 1);
+
+    /*
+     * A request larger than the limit is refused without sending anything.
+     */
+
+    at_cmd_test_clear_output();
+    AT_CMD_TEST_INPUT("AT+00305;DiagSource,{\"bytes\":100000000};");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+H") == 0);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0015,5;1,Invalid bytes;") == 1);
+    at_cmd_test_clear_output();
+}
+
+
+int main(void)
+{
+    AT_CMD_TEST_CHECK(at_cmd_test_init(NULL, 16) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands(g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+
+    test_app_cmd_id();
+    test_diag_cmds();
+
+    return at_cmd_test_finish();
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+/**
+ * @file test_flow.c
+ * @brief Command queue flow control and credit messages
+ *
+ * Checks that the host is told the number of free command queue entries as it
+ * changes, that the changes are coalesced, that input keeps flowing while the
+ * error thread waits to send them, and that the transport is only stopped while
+ * the queue is full.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_PING                    (1)
+#define TEST_QUEUE_LEN                      (4)
+
+#define TEST_BLOCK_MS                       (500)
+#define TEST_WAIT_MS                        (1000)
+#define TEST_SETTLE_US                      (50 * 1000)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static uint32_t g_flow_calls;
+static bool g_flow_stopped;
+
+static const at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "Ping", .cmd_id = TEST_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static void test_flow_control(bool stop, void *opaque)
+{
+    (void)opaque;
+
+    g_flow_calls++;
+    g_flow_stopped = stop;
+}
+
+
+static void test_take_cmd(void)
+{
+    at_cmd_msg_base_t *msg;
+
+    msg = at_cmd_test_get_msg(0);
+    AT_CMD_TEST_CHECK(msg != NULL);
+    free(msg);
+}
+
+
+static uint32_t test_time_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+
+/** Wait for the error thread to send a string.
+ *
+ * @return true if the string was sent.
+ */
+
+static bool test_wait_output(const char *str)
+{
+    uint32_t i;
+
+    for (i = 0; i < TEST_WAIT_MS && at_cmd_test_output_count(str) == 0; i++)
+    {
+        usleep(1000);
+    }
+
+    return (at_cmd_test_output_count(str) > 0);
+}
+
+
+static void *test_unblock_thread(void *arg)
+{
+    (void)arg;
+
+    usleep(TEST_BLOCK_MS * 1000);
+    at_cmd_test_block_output(false);
+
+    return NULL;
+}
+
+
+static void test_credits(void)
+{
+    /*
+     * The first input advertises what is left of the initial window.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00041;Ping;");
+    AT_CMD_TEST_CHECK(test_wait_output("{\"credits\":3}"));
+    usleep(TEST_SETTLE_US);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Credits") <= 2);
+    at_cmd_test_clear_output();
+
+    /*
+     * Changes that come faster than the minimum interval are coalesced. The last
+     * entry stops input until the application takes a command.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00042;Ping;");
+    AT_CMD_TEST_INPUT("AT+00043;Ping;");
+    AT_CMD_TEST_INPUT("AT+00044;Ping;");
+    AT_CMD_TEST_CHECK(g_flow_calls == 1 && g_flow_stopped);
+    AT_CMD_TEST_CHECK(AT_CMD_TEST_INPUT("AT+00045;Ping;") == 0);
+    AT_CMD_TEST_CHECK(test_wait_output("{\"credits\":0}"));
+    usleep(TEST_SETTLE_US);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Credits") <= 2);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_blocked_output(void)
+{
+    pthread_t thread;
+    uint32_t start;
+    uint32_t i;
+
+    /*
+     * Stall the transport while the error thread sends a count. The transport is
+     * released after TEST_BLOCK_MS so a stalled input fails the checks rather than hanging.
+     */
+
+    at_cmd_test_block_output(true);
+    pthread_create(&thread, NULL, test_unblock_thread, NULL);
+    start = test_time_ms();
+
+    test_take_cmd();
+    test_take_cmd();
+    AT_CMD_TEST_CHECK(AT_CMD_TEST_INPUT("AT+00045;Ping;") == 14);
+    for (i = 0; i < TEST_WAIT_MS && !at_cmd_test_output_waiting(); i++)
+    {
+        usleep(1000);
+    }
+    AT_CMD_TEST_CHECK(at_cmd_test_output_waiting());
+
+    /*
+     * Input and flow control carry on while the count waits for the output.
+     */
+
+    test_take_cmd();
+    AT_CMD_TEST_CHECK(AT_CMD_TEST_INPUT("AT+00046;Ping;") == 14);
+    AT_CMD_TEST_CHECK(AT_CMD_TEST_INPUT("AT+00047;Ping;") == 14);
+    AT_CMD_TEST_CHECK(test_time_ms() - start < TEST_BLOCK_MS / 2);
+    AT_CMD_TEST_CHECK(g_flow_calls == 3 && g_flow_stopped);
+    pthread_join(thread, NULL);
+
+    /*
+     * Once the output moves the stalled count is followed by the latest one only.
+     */
+
+    AT_CMD_TEST_CHECK(test_wait_output("{\"credits\":0}"));
+    usleep(TEST_SETTLE_US);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Credits") == 2);
+    AT_CMD_TEST_CHECK(at_cmd_test_drain() == TEST_QUEUE_LEN);
+    at_cmd_test_clear_output();
+}
+
+
+int main(void)
+{
+    at_cmd_params_t params;
+
+    memset(&params, 0, sizeof(params));
+    params.flow_control      = test_flow_control;
+    params.advertise_credits = true;
+
+    AT_CMD_TEST_CHECK(at_cmd_test_init(&params, TEST_QUEUE_LEN) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands((at_cmd_def_t *)g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+
+    test_credits();
+    test_blocked_output();
+
+    return at_cmd_test_finish();
+}
@@ -0,0 +1,358 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_framer.c
+ * @brief Malformed and concatenated input streams
+ *
+ * Checks that framing errors resynchronize on the next byte and that every
+ * valid command in a stream is delivered, however the stream is split into reads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_PING                    (1)
+#define TEST_CMD_ID_ECHO                    (2)
+
+#define TEST_STREAM_SIZE                    (16 * 1024)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "Ping", .cmd_id = TEST_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser, .binary_parser = at_cmd_test_binary_parser },
+    { .cmd_name = "Echo", .cmd_id = TEST_CMD_ID_ECHO, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+static char g_stream[TEST_STREAM_SIZE];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Append a sized command frame to a buffer.
+ *
+ * @return Length of the frame.
+ */
+
+static uint32_t test_frame(char *buf, uint32_t serial, const char *body)
+{
+    return (uint32_t)sprintf(buf, "AT+%04u%lu;%s;", (unsigned)strlen(body), (unsigned long)serial, body);
+}
+
+
+/** Take the next message and check its serial number and arguments. */
+
+static void test_expect_msg(uint32_t cmd_id, uint32_t serial, const char *args)
+{
+    at_cmd_test_msg_t *msg;
+
+    msg = (at_cmd_test_msg_t *)at_cmd_test_get_msg(0);
+    AT_CMD_TEST_CHECK(msg != NULL);
+    if (msg == NULL)
+    {
+        return;
+    }
+
+    AT_CMD_TEST_CHECK(msg->base.cmd_id == cmd_id);
+    AT_CMD_TEST_CHECK(msg->base.serial == serial);
+    AT_CMD_TEST_CHECK(strcmp(msg->args, args) == 0);
+    free(msg);
+}
+
+
+static void test_single_commands(void)
+{
+    AT_CMD_TEST_INPUT("AT+00041;Ping;");
+    test_expect_msg(TEST_CMD_ID_PING, 1, "");
+
+    AT_CMD_TEST_INPUT("AT+0000;Echo,{\"a\":1};\r");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+
+    AT_CMD_TEST_INPUT("AT+00002;Echo,{\"a\":1}\r");
+    test_expect_msg(TEST_CMD_ID_ECHO, 2, "{\"a\":1}");
+
+    AT_CMD_TEST_INPUT("AT+B00073;Ping,\x01\x00;");
+    test_expect_msg(TEST_CMD_ID_PING, 3, "\x01");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S") == 1);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_concatenated_commands(void)
+{
+    uint32_t len = 0;
+    uint32_t i;
+
+    /*
+     * Many commands in one read, with line endings, noise and unsized commands between them.
+     */
+
+    for (i = 1; i <= 100; i++)
+    {
+        len += test_frame(&g_stream[len], i, (i % 2) ? "Ping" : "Echo,[1,2,3]");
+        if (i % 10 == 0)
+        {
+            len += (uint32_t)sprintf(&g_stream[len], "\r\nnoise;;AT");
+        }
+        if (i % 25 == 0)
+        {
+            len += (uint32_t)sprintf(&g_stream[len], "AT+0000%lu;Echo,unsized\r\n", (unsigned long)(1000 + i));
+        }
+    }
+
+    AT_CMD_TEST_CHECK(at_cmd_test_input(g_stream, len) == len);
+
+    for (i = 1; i <= 100; i++)
+    {
+        test_expect_msg((i % 2) ? TEST_CMD_ID_PING : TEST_CMD_ID_ECHO, i, (i % 2) ? "" : "[1,2,3]");
+        if (i % 25 == 0)
+        {
+            test_expect_msg(TEST_CMD_ID_ECHO, 1000 + i, "unsized");
+        }
+    }
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S") == 0);
+}
+
+
+static void test_split_reads(void)
+{
+    uint32_t len = 0;
+    uint32_t split;
+    uint32_t i;
+
+    len += test_frame(&g_stream[len], 7, "Echo,abc");
+    len += (uint32_t)sprintf(&g_stream[len], "AAT+ATAT+0x");
+    len += test_frame(&g_stream[len], 8, "Ping");
+
+    /*
+     * Every way of splitting the stream into two reads, then one byte per read.
+     */
+
+    for (split = 0; split <= len; split++)
+    {
+        at_cmd_test_input(g_stream, split);
+        at_cmd_test_input(&g_stream[split], len - split);
+        test_expect_msg(TEST_CMD_ID_ECHO, 7, "abc");
+        test_expect_msg(TEST_CMD_ID_PING, 8, "");
+        AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        at_cmd_test_input(&g_stream[i], 1);
+    }
+    test_expect_msg(TEST_CMD_ID_ECHO, 7, "abc");
+    test_expect_msg(TEST_CMD_ID_PING, 8, "");
+    at_cmd_test_clear_output();
+}
+
+
+static void test_header_errors(void)
+{
+    /*
+     * Each bad header is answered and the command right behind it in the same read is still found.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00x41;Ping;AT+000410;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid size digit") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 10, "");
+
+    AT_CMD_TEST_INPUT("AT+0004x;Ping;AT+000411;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid serial digit") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 11, "");
+
+    AT_CMD_TEST_INPUT("AT+000412x;Ping;AT+000412;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid format") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 12, "");
+
+    AT_CMD_TEST_INPUT("AT+00041@;Ping;AT+000413@;Ping;AT+000414@50;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid format") == 3);
+    test_expect_msg(TEST_CMD_ID_PING, 14, "");
+
+    AT_CMD_TEST_INPUT("AT+B000015;AT+000415;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid size;") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 15, "");
+
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_bad_trailer(void)
+{
+    /*
+     * A size that is too large swallows the start of the next command. The data of the
+     * bad frame is scanned again so the swallowed command is still found.
+     */
+
+    AT_CMD_TEST_INPUT("AT+000620;Ping;AT+000421;Ping;x");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("bad cmd trailer") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 21, "");
+
+    /*
+     * A size that is too small.
+     */
+
+    AT_CMD_TEST_INPUT("AT+000222;Ping;AT+000423;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("bad cmd trailer") == 2);
+    test_expect_msg(TEST_CMD_ID_PING, 23, "");
+
+    /*
+     * Errors found while rescanning the bad frame are reported together in one response.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00223;AT+xAT+yAT+z;;;;;;;;;;!AT+000425;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("bad cmd trailer") == 3);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("3 framing errors, last: Invalid size digit") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 25, "");
+
+    /*
+     * The payload of a binary command with a bad trailer is dropped, never scanned for commands.
+     */
+
+    AT_CMD_TEST_INPUT("AT+B00147;AT+00049;Ping;!");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("bad cmd trailer") == 4);
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_INPUT("AT+000424;Ping;");
+    test_expect_msg(TEST_CMD_ID_PING, 24, "");
+
+    /*
+     * A line feed in the trailer position of a sized command is a bad trailer like any
+     * other character. The command that follows must still be found.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00061;Ping;\r\nAT+000426;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("bad cmd trailer") == 5);
+    test_expect_msg(TEST_CMD_ID_PING, 26, "");
+
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_overflow(void)
+{
+    uint32_t len;
+
+    /*
+     * A sized command larger than the buffer is refused from its header.
+     */
+
+    AT_CMD_TEST_INPUT("AT+999930;Ping;AT+000431;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Input buffer size exceeded") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 31, "");
+
+    /*
+     * An unsized command that never ends overflows the buffer. Commands after it still work.
+     */
+
+    len = (uint32_t)sprintf(g_stream, "AT+000032;Echo,");
+    memset(&g_stream[len], 'x', 8000);
+    len += 8000;
+    len += (uint32_t)sprintf(&g_stream[len], "\rAT+000433;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_input(g_stream, len) == len);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Input buffer size exceeded") == 2);
+    test_expect_msg(TEST_CMD_ID_PING, 33, "");
+
+    /*
+     * A serial number that fills the buffer.
+     */
+
+    len = (uint32_t)sprintf(g_stream, "AT+0004");
+    memset(&g_stream[len], '1', 7000);
+    len += 7000;
+    len += (uint32_t)sprintf(&g_stream[len], ";Ping;AT+000434;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_input(g_stream, len) == len);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Input buffer size exceeded") == 3);
+    test_expect_msg(TEST_CMD_ID_PING, 34, "");
+
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_invalid_commands(void)
+{
+    AT_CMD_TEST_INPUT("AT+000440;Nope;AT+000441;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid cmd") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 41, "");
+
+    AT_CMD_TEST_INPUT("AT+000442;Pin;AT+000443;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("bad cmd trailer") == 1);
+    test_expect_msg(TEST_CMD_ID_PING, 43, "");
+
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    at_cmd_test_clear_output();
+}
+
+
+int main(void)
+{
+    at_cmd_params_t params;
+
+    /*
+     * Inline messages must have room for at least the message header.
+     */
+
+    memset(&params, 0, sizeof(params));
+    params.inline_msg_size = sizeof(at_cmd_msg_base_t) - 1;
+    AT_CMD_TEST_CHECK(at_cmd_test_init(&params, 256) == CY_AT_CMD_PARSER_BAD_PARAM);
+    params.inline_msg_size = AT_CMD_MAX_INLINE_MSG_SIZE + 1;
+    AT_CMD_TEST_CHECK(at_cmd_test_init(&params, 256) == CY_AT_CMD_PARSER_BAD_PARAM);
+
+    memset(&params, 0, sizeof(params));
+    AT_CMD_TEST_CHECK(at_cmd_test_init(&params, 256) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands(g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+
+    test_single_commands();
+    test_concatenated_commands();
+    test_split_reads();
+    test_header_errors();
+    test_bad_trailer();
+    test_overflow();
+    test_invalid_commands();
+
+    return at_cmd_test_finish();
+}
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_host.c
+ * @brief Host client talking to the library in the same process
+ *
+ * Frames written by the client are passed to at_cmd_parser_input() and the output of
+ * the library is passed back to at_cmd_host_input().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+#include "at_command_host.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_ECHO                    (1)
+#define TEST_CMD_ID_NOTIFY                  (2)
+
+#define TEST_MAX_RESPONSES                  (64)
+#define TEST_MAX_MSGS                       (32)
+
+/******************************************************
+ *                 Type Definitions
+ ******************************************************/
+
+typedef struct
+{
+    uint32_t serial;
+    uint32_t status;
+    char text[AT_CMD_TEST_MAX_ARGS];
+} test_response_t;
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static at_cmd_host_t g_host;
+
+static test_response_t g_responses[TEST_MAX_RESPONSES];
+static uint32_t g_num_responses;
+static test_response_t g_unmatched;
+static uint32_t g_num_unmatched;
+static uint32_t g_num_async;
+static char g_async_name[32];
+static char g_async_text[AT_CMD_TEST_MAX_ARGS];
+static uint32_t g_last_timeout_ms;
+
+static at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "Echo", .cmd_id = TEST_CMD_ID_ECHO, .cmd_parser = at_cmd_test_cmd_parser, .binary_parser = at_cmd_test_binary_parser },
+    { .cmd_name = "Notify", .cmd_id = TEST_CMD_ID_NOTIFY, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static cy_rslt_t test_host_write(const uint8_t *data, uint32_t len, void *opaque)
+{
+    (void)opaque;
+
+    return (at_cmd_test_input(data, len) == len) ? CY_RSLT_SUCCESS : CY_AT_CMD_PARSER_ERROR;
+}
+
+
+static void test_host_response(uint32_t serial, uint32_t status, const char *text, uint32_t text_len, void *arg)
+{
+    test_response_t *rsp;
+
+    (void)arg;
+
+    if (g_num_responses == TEST_MAX_RESPONSES)
+    {
+        return;
+    }
+    rsp = &g_responses[g_num_responses++];
+    rsp->serial = serial;
+    rsp->status = status;
+    snprintf(rsp->text, sizeof(rsp->text), "%.*s", (int)text_len, text);
+}
+
+
+static void test_host_unmatched(uint32_t serial, uint32_t status, const char *text, uint32_t text_len, void *arg)
+{
+    (void)arg;
+
+    g_num_unmatched++;
+    g_unmatched.serial = serial;
+    g_unmatched.status = status;
+    snprintf(g_unmatched.text, sizeof(g_unmatched.text), "%.*s", (int)text_len, text);
+}
+
+
+static void test_host_async(uint32_t serial, const char *name, const char *text, uint32_t text_len, void *arg)
+{
+    g_num_async++;
+    *(uint32_t *)arg = serial;
+    snprintf(g_async_name, sizeof(g_async_name), "%s", name);
+    snprintf(g_async_text, sizeof(g_async_text), "%.*s", (int)text_len, text);
+}
+
+
+/** Pass the output of the library to the client. */
+static void test_pump(void)
+{
+    static char buffer[AT_CMD_TEST_OUTPUT_SIZE];
+    uint32_t len = at_cmd_test_output_len();
+
+    /*
+     * The output is copied since the client callbacks may send commands, which adds to it.
+     */
+
+    memcpy(buffer, at_cmd_test_output(), len);
+    at_cmd_test_clear_output();
+    at_cmd_host_input(&g_host, (const uint8_t *)buffer, len);
+}
+
+
+/** Run the queued commands on the device, answering them in the reverse order they were received. */
+static void test_device_run(void)
+{
+    at_cmd_test_msg_t *msgs[TEST_MAX_MSGS];
+    at_cmd_test_msg_t *msg;
+    char text[AT_CMD_TEST_MAX_ARGS + 16];
+    uint32_t count = 0;
+
+    while (count < TEST_MAX_MSGS && (msg = (at_cmd_test_msg_t *)at_cmd_test_get_msg(0)) != NULL)
+    {
+        msgs[count++] = msg;
+    }
+
+    while (count > 0)
+    {
+        msg = msgs[--count];
+        g_last_timeout_ms = msg->base.timeout_ms;
+
+        if (msg->base.cmd_id == TEST_CMD_ID_NOTIFY)
+        {
+            snprintf(text, sizeof(text), "Event,%s", msg->args);
+            at_cmd_parser_send_cmd_async_response(msg->base.serial, text);
+#ifdef ENABLE_AT_CMD_COMPRESSION
+            at_cmd_parser_send_cmd_async_response_compressed(msg->base.serial,
+                                                             "Event,{\"data\":\"abcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcd\"}");
+#endif
+            at_cmd_parser_send_cmd_response(msg->base.serial, AT_CMD_STATUS_SUCCESS, NULL);
+        }
+        else
+        {
+            snprintf(text, sizeof(text), "%lu:%s", (unsigned long)msg->len, msg->args);
+            at_cmd_parser_send_cmd_response(msg->base.serial, AT_CMD_STATUS_SUCCESS, text);
+        }
+        free(msg);
+    }
+
+    test_pump();
+}
+
+
+static void test_pipelined(void)
+{
+    uint32_t serials[16];
+    char args[16];
+    uint32_t found;
+    uint32_t i;
+    uint32_t j;
+
+    /*
+     * Send all of the commands before the device runs any of them. The responses come back
+     * in the reverse order and must each reach the command with the same serial number.
+     */
+
+    for (i = 0; i < 16; i++)
+    {
+        snprintf(args, sizeof(args), "[%lu]", (unsigned long)i);
+        AT_CMD_TEST_CHECK(at_cmd_host_send(&g_host, "Echo", args, (uint32_t)strlen(args), test_host_response, NULL, NULL,
+                                           &serials[i]) == CY_RSLT_SUCCESS);
+    }
+    AT_CMD_TEST_CHECK(at_cmd_host_pending(&g_host) == 16);
+
+    test_device_run();
+
+    AT_CMD_TEST_CHECK(g_num_responses == 16);
+    AT_CMD_TEST_CHECK(g_responses[0].serial == serials[15]);
+    for (i = 0; i < 16; i++)
+    {
+        found = 0;
+        snprintf(args, sizeof(args), "%lu:[%lu]", (unsigned long)(i < 10 ? 3 : 4), (unsigned long)i);
+        for (j = 0; j < g_num_responses; j++)
+        {
+            if (g_responses[j].serial == serials[i] && g_responses[j].status == AT_CMD_STATUS_SUCCESS &&
+                strcmp(g_responses[j].text, args) == 0)
+            {
+                found++;
+            }
+        }
+        AT_CMD_TEST_CHECK(found == 1);
+    }
+    AT_CMD_TEST_CHECK(at_cmd_host_pending(&g_host) == 0);
+    AT_CMD_TEST_CHECK(g_num_unmatched == 0);
+    g_num_responses = 0;
+}
+
+
+static void test_binary(void)
+{
+    static const uint8_t data[] = { 'A', 'T', '+', ';', '\r', '\n', 0x00, 0xff, ';' };
+    uint32_t serial;
+
+    AT_CMD_TEST_CHECK(at_cmd_host_send_binary(&g_host, "Echo", data, sizeof(data), test_host_response, NULL, NULL,
+                                              &serial) == CY_RSLT_SUCCESS);
+    test_device_run();
+
+    AT_CMD_TEST_CHECK(g_num_responses == 1);
+    AT_CMD_TEST_CHECK(g_responses[0].serial == serial && strcmp(g_responses[0].text, "9:AT+;\r\n") == 0);
+    AT_CMD_TEST_CHECK(g_num_unmatched == 0);
+    g_num_responses = 0;
+}
+
+
+static void test_async(void)
+{
+    uint32_t async_serial = 0;
+    uint32_t serial;
+
+    /*
+     * A command sent with an async callback gets the messages carrying its serial number
+     * and stays pending after its response until it is released.
+     */
+
+    AT_CMD_TEST_CHECK(at_cmd_host_send(&g_host, "Notify", "{\"n\":1}", 7, test_host_response, test_host_async, &async_serial,
+                                       &serial) == CY_RSLT_SUCCESS);
+    test_device_run();
+
+    AT_CMD_TEST_CHECK(g_num_responses == 1 && g_responses[0].serial == serial && g_responses[0].text[0] == '\0');
+    AT_CMD_TEST_CHECK(async_serial == serial);
+    AT_CMD_TEST_CHECK(strcmp(g_async_name, "Event") == 0);
+#ifdef ENABLE_AT_CMD_COMPRESSION
+    AT_CMD_TEST_CHECK(g_num_async == 2);
+    AT_CMD_TEST_CHECK(strcmp(g_async_text, "{\"data\":\"abcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcdabcd\"}") == 0);
+#else
+    AT_CMD_TEST_CHECK(g_num_async == 1);
+    AT_CMD_TEST_CHECK(strcmp(g_async_text, "{\"n\":1}") == 0);
+#endif
+    AT_CMD_TEST_CHECK(at_cmd_host_pending(&g_host) == 1);
+    AT_CMD_TEST_CHECK(at_cmd_host_release(&g_host, serial) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_host_pending(&g_host) == 0);
+    g_num_responses = 0;
+}
+
+
+static void test_errors(void)
+{
+    uint32_t serial;
+
+    /*
+     * An unknown command is answered with serial number 0, which the client can't match.
+     */
+
+    AT_CMD_TEST_CHECK(at_cmd_host_send(&g_host, "Nope", NULL, 0, test_host_response, NULL, NULL, &serial) == CY_RSLT_SUCCESS);
+    test_device_run();
+
+    AT_CMD_TEST_CHECK(g_num_responses == 0);
+    AT_CMD_TEST_CHECK(g_num_unmatched == 1 && g_unmatched.serial == 0 && g_unmatched.status == AT_CMD_STATUS_ERROR);
+    AT_CMD_TEST_CHECK(strcmp(g_unmatched.text, "Invalid cmd") == 0);
+    AT_CMD_TEST_CHECK(at_cmd_host_release(&g_host, serial) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_host_release(&g_host, serial) == CY_AT_CMD_PARSER_BAD_PARAM);
+}
+
+
+static void test_deadline(void)
+{
+    /*
+     * The deadline set on the client reaches the command message on the device.
+     */
+
+    at_cmd_host_set_timeout(&g_host, 2500);
+    AT_CMD_TEST_CHECK(at_cmd_host_send(&g_host, "Echo", NULL, 0, test_host_response, NULL, NULL, NULL) == CY_RSLT_SUCCESS);
+    test_device_run();
+    at_cmd_host_set_timeout(&g_host, 0);
+
+    AT_CMD_TEST_CHECK(g_last_timeout_ms == 2500);
+    AT_CMD_TEST_CHECK(g_num_responses == 1 && g_responses[0].status == AT_CMD_STATUS_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_host_pending(&g_host) == 0);
+    g_num_responses = 0;
+}
+
+
+int main(void)
+{
+    AT_CMD_TEST_CHECK(at_cmd_test_init(NULL, TEST_MAX_MSGS) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands(g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_host_init(&g_host, test_host_write, NULL, NULL, test_host_unmatched, NULL) == CY_RSLT_SUCCESS);
+
+    test_pipelined();
+    test_binary();
+    test_async();
+    test_errors();
+    test_deadline();
+
+    AT_CMD_TEST_CHECK(g_host.rx_errors == 0);
+
+    return at_cmd_test_finish();
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_limits.c
+ * @brief Per command admission limits
+ *
+ * Checks that an in flight limit is only released by the response that answers
+ * an admitted command, and that the library keeps no reference to the limits of
+ * an unregistered table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_SLOW                    (1)
+#define TEST_CMD_ID_FAST                    (2)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static const at_cmd_limits_t g_slow_limits =
+{
+    .max_in_flight = 1,
+};
+
+static const at_cmd_limits_t g_fast_limits =
+{
+    .rate  = 1,
+    .burst = 2,
+};
+
+static const at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "Slow", .cmd_id = TEST_CMD_ID_SLOW, .cmd_parser = at_cmd_test_cmd_parser, .limits = &g_slow_limits },
+    { .cmd_name = "Fast", .cmd_id = TEST_CMD_ID_FAST, .cmd_parser = at_cmd_test_cmd_parser, .limits = &g_fast_limits },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Take the next queued command.
+ *
+ * @return Serial number of the command, or -1 if there was none.
+ */
+
+static int test_take_cmd(void)
+{
+    at_cmd_msg_base_t *msg;
+    int serial;
+
+    msg = at_cmd_test_get_msg(0);
+    if (msg == NULL)
+    {
+        return -1;
+    }
+
+    serial = (int)msg->serial;
+    free(msg);
+
+    return serial;
+}
+
+
+static uint32_t test_in_flight(const at_cmd_limits_t *limits)
+{
+    at_cmd_limit_stats_t stats;
+
+    if (at_cmd_parser_get_limit_stats(limits, &stats) != CY_RSLT_SUCCESS)
+    {
+        return 0xFFFFFFFF;
+    }
+
+    return stats.in_flight;
+}
+
+
+static void test_library_errors(void)
+{
+    /*
+     * A command with serial number 0 is left unanswered. Errors the library sends
+     * with serial number 0 must not release it.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00040;Slow;");
+    AT_CMD_TEST_CHECK(test_take_cmd() == 0);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 1);
+
+    AT_CMD_TEST_INPUT("AT+X\r");
+    AT_CMD_TEST_INPUT("AT+00070;Missing;");
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid") == 2);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 1);
+
+    AT_CMD_TEST_INPUT("AT+00045;Slow;");
+    AT_CMD_TEST_CHECK(test_take_cmd() == -1);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0020,5;2,Too many in flight;") == 1);
+
+    /*
+     * The application's response releases it.
+     */
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(0, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 0);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_builder_response(void)
+{
+    at_cmd_response_t rsp;
+
+    AT_CMD_TEST_INPUT("AT+00046;Slow;");
+    AT_CMD_TEST_CHECK(test_take_cmd() == 6);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 1);
+
+    /*
+     * A response for another serial number doesn't release it.
+     */
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(7, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 1);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_response_begin(&rsp, 6, AT_CMD_STATUS_SUCCESS) == CY_RSLT_SUCCESS);
+    at_cmd_parser_response_append(&rsp, "done", 4);
+    AT_CMD_TEST_CHECK(at_cmd_parser_response_send(&rsp) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 0);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_rate(void)
+{
+    at_cmd_limit_stats_t stats;
+
+    AT_CMD_TEST_INPUT("AT+00048;Fast;AT+00049;Fast;AT+000410;Fast;");
+    AT_CMD_TEST_CHECK(test_take_cmd() == 8);
+    AT_CMD_TEST_CHECK(test_take_cmd() == 9);
+    AT_CMD_TEST_CHECK(test_take_cmd() == -1);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0014,10;2,Rate limited;") == 1);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_get_limit_stats(&g_fast_limits, &stats) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(stats.rejected == 1 && stats.in_flight == 0);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_batch(void)
+{
+    /*
+     * The second command of the batch is refused, and answering the first one releases it.
+     */
+
+    AT_CMD_TEST_INPUT("AT+001520;Batch,Slow\x1eSlow;");
+    AT_CMD_TEST_CHECK(test_take_cmd() == 20);
+    AT_CMD_TEST_CHECK(test_take_cmd() == -1);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 1);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(20, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 0);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0057,20;2,[{\"status\":2,\"text\":\"Too many in flight\"},{\"status\":0}];") == 1);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_unregister(void)
+{
+    at_cmd_def_t *cmds;
+
+    /*
+     * The limits of an unregistered table are forgotten, including commands in flight under them.
+     */
+
+    cmds = malloc(sizeof(g_test_cmds));
+    memcpy(cmds, g_test_cmds, sizeof(g_test_cmds));
+    AT_CMD_TEST_CHECK(at_cmd_parser_swap_commands((at_cmd_def_t *)g_test_cmds, cmds, 2) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 0);
+
+    AT_CMD_TEST_INPUT("AT+000411;Slow;");
+    AT_CMD_TEST_CHECK(test_take_cmd() == 11);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 1);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_unregister_commands(cmds) == CY_RSLT_SUCCESS);
+    free(cmds);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 0xFFFFFFFF);
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(11, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+
+    /*
+     * Registering the limits again starts them afresh.
+     */
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands((at_cmd_def_t *)g_test_cmds, 2) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 0);
+    AT_CMD_TEST_INPUT("AT+000412;Slow;");
+    AT_CMD_TEST_CHECK(test_take_cmd() == 12);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 1);
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(12, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(test_in_flight(&g_slow_limits) == 0);
+    at_cmd_test_clear_output();
+}
+
+
+int main(void)
+{
+    AT_CMD_TEST_CHECK(at_cmd_test_init(NULL, 16) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands((at_cmd_def_t *)g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+
+    test_library_errors();
+    test_builder_response();
+    test_rate();
+    test_batch();
+    test_unregister();
+
+    return at_cmd_test_finish();
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_response.c
+ * @brief Status responses built in place
+ *
+ * Checks that a response sent with the response builder updates the same state
+ * as one sent with at_cmd_parser_send_cmd_response(), and is combined into the
+ * response of a batch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_PING                    (1)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "Ping", .cmd_id = TEST_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Answer the next queued command with the response builder.
+ *
+ * @return Serial number of the command, 0 if there was none.
+ */
+
+static uint32_t test_build_response(uint32_t status, const char *text)
+{
+    at_cmd_response_t rsp;
+    at_cmd_msg_base_t *msg;
+    uint32_t serial;
+
+    msg = at_cmd_test_get_msg(0);
+    if (msg == NULL)
+    {
+        return 0;
+    }
+
+    serial = msg->serial;
+    free(msg);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_response_begin(&rsp, serial, status) == CY_RSLT_SUCCESS);
+    at_cmd_parser_response_append(&rsp, text, strlen(text));
+    AT_CMD_TEST_CHECK(at_cmd_parser_response_send(&rsp) == CY_RSLT_SUCCESS);
+
+    return serial;
+}
+
+
+static void test_retransmit(void)
+{
+    /*
+     * A retransmit of a command answered with the builder gets the cached response.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00041;Ping;");
+    AT_CMD_TEST_CHECK(test_build_response(AT_CMD_STATUS_SUCCESS, "pong") == 1);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0006,1;0,pong;") == 1);
+
+    AT_CMD_TEST_INPUT("AT+00041;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0006,1;0,pong;") == 2);
+
+    /*
+     * A response without text.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00042;Ping;");
+    AT_CMD_TEST_CHECK(test_build_response(AT_CMD_STATUS_ERROR, "") == 2);
+    AT_CMD_TEST_INPUT("AT+00042;Ping;");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0001,2;1;") == 2);
+    at_cmd_test_clear_output();
+}
+
+
+static void test_batch(void)
+{
+    char buf[128];
+    uint32_t i;
+
+    /*
+     * Run more batches than can be waiting at once to show that each one completes.
+     */
+
+    for (i = 0; i < 3; i++)
+    {
+        sprintf(buf, "AT+0015%lu;Batch,Ping\x1ePing;", (unsigned long)(10 + i));
+        at_cmd_test_input(buf, strlen(buf));
+        AT_CMD_TEST_CHECK(test_build_response(AT_CMD_STATUS_SUCCESS, "pong") == 10 + i);
+        AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S") == 0);
+        AT_CMD_TEST_CHECK(test_build_response(AT_CMD_STATUS_ERROR, "") == 10 + i);
+        sprintf(buf, "+S0043,%lu;1,[{\"status\":0,\"text\":\"pong\"},{\"status\":1}];\r\n", (unsigned long)(10 + i));
+        AT_CMD_TEST_CHECK(strcmp(at_cmd_test_output(), buf) == 0);
+        at_cmd_test_clear_output();
+    }
+
+    /*
+     * Builder and string responses in the same batch.
+     */
+
+    AT_CMD_TEST_INPUT("AT+00154;Batch,Ping\x1ePing;");
+    AT_CMD_TEST_CHECK(test_build_response(AT_CMD_STATUS_SUCCESS, "pong") == 4);
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(4, AT_CMD_STATUS_SUCCESS, "ok") == CY_RSLT_SUCCESS);
+    free(at_cmd_test_get_msg(0));
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S") == 1);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("\"text\":\"ok\"") == 1);
+    at_cmd_test_clear_output();
+}
+
+
+int main(void)
+{
+    AT_CMD_TEST_CHECK(at_cmd_test_init(NULL, 16) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands(g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+
+    test_retransmit();
+    test_batch();
+
+    return at_cmd_test_finish();
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_stream.c
+ * @brief Streamed commands
+ *
+ * Streamed commands are admitted like framed commands, so the retransmit cache,
+ * command limits and host deadlines are checked here as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_UPLOAD                  (1)
+#define TEST_CMD_ID_PING                    (2)
+#define TEST_CMD_ID_BULK                    (3)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static uint32_t g_stream_bytes;
+static uint32_t g_stream_ends;
+static uint32_t g_stream_serial;
+
+static char g_input[16 * 1024];
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+static cy_rslt_t test_stream_begin(uint32_t cmd_id, uint32_t serial, uint32_t data_len, void **context)
+{
+    (void)cmd_id;
+    (void)data_len;
+
+    g_stream_serial = serial;
+    g_stream_bytes  = 0;
+    *context       = &g_stream_bytes;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+static cy_rslt_t test_stream_data(void *context, uint8_t *data, uint32_t len)
+{
+    (void)data;
+
+    *(uint32_t *)context += len;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+static at_cmd_msg_base_t *test_stream_end(void *context, bool complete)
+{
+    at_cmd_test_msg_t *msg;
+
+    g_stream_ends++;
+    if (!complete)
+    {
+        return NULL;
+    }
+
+    msg = calloc(1, sizeof(at_cmd_test_msg_t));
+    if (msg != NULL)
+    {
+        msg->base.cmd_id = TEST_CMD_ID_UPLOAD;
+        msg->base.serial = g_stream_serial;
+        msg->len         = *(uint32_t *)context;
+    }
+
+    return (msg != NULL) ? &msg->base : NULL;
+}
+
+
+static const at_cmd_stream_callbacks_t g_stream_callbacks =
+{
+    .begin = test_stream_begin,
+    .data  = test_stream_data,
+    .end   = test_stream_end,
+};
+
+static const at_cmd_limits_t g_bulk_limits =
+{
+    .max_in_flight = 1,
+};
+
+static at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "Upload", .cmd_id = TEST_CMD_ID_UPLOAD, .stream_callbacks = &g_stream_callbacks },
+    { .cmd_name = "Ping", .cmd_id = TEST_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser },
+    { .cmd_name = "Bulk", .cmd_id = TEST_CMD_ID_BULK, .stream_callbacks = &g_stream_callbacks, .limits = &g_bulk_limits },
+};
+
+
+static void test_stream_command(void)
+{
+    at_cmd_test_msg_t *msg;
+    uint32_t len;
+
+    len = (uint32_t)sprintf(g_input, "AT+L000020005;Upload,");
+    memset(&g_input[len], 'd', 1993);
+    len += 1993;
+    g_input[len++] = ';';
+
+    AT_CMD_TEST_CHECK(at_cmd_test_input(g_input, len) == len);
+    msg = (at_cmd_test_msg_t *)at_cmd_test_get_msg(0);
+    AT_CMD_TEST_CHECK(msg != NULL && msg->base.cmd_id == TEST_CMD_ID_UPLOAD && msg->len == 1993);
+    free(msg);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S") == 0);
+}
+
+
+static void test_stream_long_serial(void)
+{
+    at_cmd_msg_base_t *msg;
+    uint32_t len;
+
+    /*
+     * A serial number that almost fills the buffer followed by the longest command name
+     * must not write the name past the end of the buffer.
+     */
+
+    len = (uint32_t)sprintf(g_input, "AT+L00000100");
+    memset(&g_input[len], '1', 6170);
+    len += 6170;
+    g_input[len++] = ';';
+    memset(&g_input[len], 'n', 100);
+    len += 100;
+    g_input[len++] = ';';
+    len += (uint32_t)sprintf(&g_input[len], "AT+00046;Ping;");
+
+    AT_CMD_TEST_CHECK(at_cmd_test_input(g_input, len) == len);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("Invalid cmd") == 1);
+
+    msg = at_cmd_test_get_msg(0);
+    AT_CMD_TEST_CHECK(msg != NULL && msg->cmd_id == TEST_CMD_ID_PING && msg->serial == 6);
+    free(msg);
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    at_cmd_test_clear_output();
+}
+
+
+/** Check that one streamed command was delivered.
+ *
+ * @param[in] serial     : Serial number of the command.
+ * @param[in] timeout_ms : Deadline the message should carry.
+ */
+
+static void test_expect_stream(uint32_t serial, uint32_t timeout_ms)
+{
+    at_cmd_msg_base_t *msg;
+
+    msg = at_cmd_test_get_msg(0);
+    AT_CMD_TEST_CHECK(msg != NULL && msg->serial == serial && msg->timeout_ms == timeout_ms);
+    free(msg);
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+}
+
+
+static void test_stream_admission(void)
+{
+    uint32_t ends;
+
+    /*
+     * A retransmitted stream is not run again. Once answered the response is sent again.
+     */
+
+    ends = g_stream_ends;
+    AT_CMD_TEST_INPUT("AT+L000000117;Upload,abcd;");
+    test_expect_stream(7, 0);
+    AT_CMD_TEST_INPUT("AT+L000000117;Upload,abcd;");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(g_stream_ends == ends + 1);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(7, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_INPUT("AT+L000000117;Upload,abcd;");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(g_stream_ends == ends + 1);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count("+S0001,7;0;") == 2);
+    at_cmd_test_clear_output();
+
+    /*
+     * The in flight limit of a streamed command is held until the application answers it.
+     */
+
+    AT_CMD_TEST_INPUT("AT+L000000099;Bulk,abcd;");
+    test_expect_stream(9, 0);
+    AT_CMD_TEST_INPUT("AT+L0000000910;Bulk,abcd;");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count(",10;2,Too many in flight;") == 1);
+    AT_CMD_TEST_CHECK(g_stream_ends == ends + 2);
+
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(9, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_INPUT("AT+L0000000911;Bulk,abcd;");
+    test_expect_stream(11, 0);
+    AT_CMD_TEST_CHECK(at_cmd_parser_send_cmd_response(11, AT_CMD_STATUS_SUCCESS, NULL) == CY_RSLT_SUCCESS);
+    at_cmd_test_clear_output();
+
+    /*
+     * The host's deadline is passed on and is measured from the header.
+     */
+
+    AT_CMD_TEST_INPUT("AT+L0000001112@60000;Upload,abcd;");
+    test_expect_stream(12, 60000);
+
+    AT_CMD_TEST_INPUT("AT+L0000001113@1;Upload,ab");
+    cy_rtos_delay_milliseconds(5);
+    AT_CMD_TEST_INPUT("cd;");
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+    AT_CMD_TEST_CHECK(at_cmd_test_output_count(",13;3,Deadline expired;") == 1);
+    at_cmd_test_clear_output();
+}
+
+
+int main(void)
+{
+    AT_CMD_TEST_CHECK(at_cmd_test_init(NULL, 16) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands(g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+
+    test_stream_command();
+    test_stream_long_serial();
+    test_stream_admission();
+
+    return at_cmd_test_finish();
+}
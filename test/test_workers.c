@@ -0,0 +1,185 @@
+/*
+ * Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+ * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+ *
+ * This software, including source code, documentation and related
+ * materials ("Software") is owned by Cypress Semiconductor Corporation
+ * or one of its affiliates ("Cypress") and is protected by and subject to
+ * worldwide patent protection (United States and foreign),
+ * United States copyright laws and international treaty provisions.
+ * Therefore, you may use this Software only as provided in the license
+ * agreement accompanying the software package from which you
+ * obtained this Software ("EULA").
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software
+ * source code solely for use in connection with Cypress's
+ * integrated circuit products.  Any reproduction, modification, translation,
+ * compilation, or representation of this Software except as specified
+ * above is prohibited without the express written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer
+ * of such system or application assumes all risk of such use and in doing
+ * so agrees to indemnify Cypress against all liability.
+ */
+
+/**
+ * @file test_workers.c
+ * @brief Commands handed to worker threads
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "at_cmd_test.h"
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define TEST_CMD_ID_PING                    (1)
+
+#define TEST_NUM_COMMANDS                   (50)
+#define TEST_BLOCK_MS                       (500)
+
+/******************************************************
+ *               Variable Definitions
+ ******************************************************/
+
+static atomic_bool g_block_writes;
+static atomic_bool g_write_blocked;
+
+static char g_input[TEST_NUM_COMMANDS * 32];
+
+static at_cmd_def_t g_test_cmds[] =
+{
+    { .cmd_name = "Ping", .cmd_id = TEST_CMD_ID_PING, .cmd_parser = at_cmd_test_cmd_parser },
+};
+
+/******************************************************
+ *               Function Definitions
+ ******************************************************/
+
+/** Transport that waits while writes are blocked, like a UART that the host has flowed off. */
+static cy_rslt_t test_write_async(uint8_t *buffer, uint32_t length, void *opaque)
+{
+    (void)buffer;
+    (void)length;
+    (void)opaque;
+
+    while (atomic_load(&g_block_writes))
+    {
+        atomic_store(&g_write_blocked, true);
+        usleep(1000);
+    }
+
+    return at_cmd_parser_write_complete(CY_RSLT_SUCCESS);
+}
+
+
+static void *test_unblock_thread(void *arg)
+{
+    (void)arg;
+
+    usleep(TEST_BLOCK_MS * 1000);
+    atomic_store(&g_block_writes, false);
+
+    return NULL;
+}
+
+
+static uint32_t test_time_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+
+static void test_order(void)
+{
+    at_cmd_msg_base_t *msg;
+    uint32_t len = 0;
+    uint32_t i;
+
+    /*
+     * The workers finish the commands in any order, but they are delivered in the order received.
+     */
+
+    for (i = 1; i <= TEST_NUM_COMMANDS; i++)
+    {
+        len += (uint32_t)sprintf(&g_input[len], "AT+0004%lu;Ping;", (unsigned long)i);
+    }
+    AT_CMD_TEST_CHECK(at_cmd_test_input(g_input, len) == len);
+
+    for (i = 1; i <= TEST_NUM_COMMANDS; i++)
+    {
+        msg = at_cmd_test_get_msg(1000);
+        AT_CMD_TEST_CHECK(msg != NULL && msg->serial == i);
+        free(msg);
+    }
+}
+
+
+static void test_blocked_delivery(void)
+{
+    at_cmd_msg_base_t *msg;
+    pthread_t thread;
+    uint32_t start;
+    uint32_t i;
+
+    /*
+     * The error response for an unknown command is written while the worker delivers the
+     * command. With the transport stalled, new input must still be taken.
+     */
+
+    atomic_store(&g_block_writes, true);
+    AT_CMD_TEST_INPUT("AT+000490;Nope;");
+    for (i = 0; i < 1000 && !atomic_load(&g_write_blocked); i++)
+    {
+        usleep(1000);
+    }
+    AT_CMD_TEST_CHECK(atomic_load(&g_write_blocked));
+
+    pthread_create(&thread, NULL, test_unblock_thread, NULL);
+    start = test_time_ms();
+    AT_CMD_TEST_INPUT("AT+000491;Ping;");
+    AT_CMD_TEST_CHECK(test_time_ms() - start < TEST_BLOCK_MS / 2);
+    pthread_join(thread, NULL);
+
+    msg = at_cmd_test_get_msg(1000);
+    AT_CMD_TEST_CHECK(msg != NULL && msg->serial == 91);
+    free(msg);
+    AT_CMD_TEST_CHECK(at_cmd_test_get_msg(0) == NULL);
+}
+
+
+int main(void)
+{
+    at_cmd_params_t params;
+
+    memset(&params, 0, sizeof(params));
+    params.write_data_async = test_write_async;
+    AT_CMD_TEST_CHECK(at_cmd_test_init(&params, TEST_NUM_COMMANDS + 8) == CY_RSLT_SUCCESS);
+    AT_CMD_TEST_CHECK(at_cmd_parser_register_commands(g_test_cmds, sizeof(g_test_cmds) / sizeof(g_test_cmds[0])) == CY_RSLT_SUCCESS);
+
+    test_order();
+    test_blocked_delivery();
+
+    return at_cmd_test_finish();
+}